@@ -0,0 +1,143 @@
+#include "ahrs.h"
+#include "fixmath.h"
+#include "heading.h"
+
+static int32_t q[4];        // orientation, body to earth, Q30
+static int32_t integral[3]; // gyro bias estimate, gyro LSB << 15
+static int32_t step;        // half the update period in rad per gyro LSB, Q30
+
+uint32_t ahrs_cycles_last = 0;
+uint32_t ahrs_cycles_max = 0;
+
+// rotation matrix (body to earth) of the current quaternion, Q15
+static void rotation(int32_t r[3][3]) {
+    int32_t w = q[0] >> 15, x = q[1] >> 15, y = q[2] >> 15, z = q[3] >> 15;
+    int32_t xx = x * x, yy = y * y, zz = z * z;
+    int32_t xy = x * y, xz = x * z, yz = y * z;
+    int32_t wx = w * x, wy = w * y, wz = w * z;
+
+    r[0][0] = 32768 - ((yy + zz) >> 14);
+    r[0][1] = (xy - wz) >> 14;
+    r[0][2] = (xz + wy) >> 14;
+    r[1][0] = (xy + wz) >> 14;
+    r[1][1] = 32768 - ((xx + zz) >> 14);
+    r[1][2] = (yz - wx) >> 14;
+    r[2][0] = (xz - wy) >> 14;
+    r[2][1] = (yz + wx) >> 14;
+    r[2][2] = 32768 - ((xx + yy) >> 14);
+}
+
+static int16_t sat16(int32_t value) {
+    if (value > INT16_MAX) {
+        return INT16_MAX;
+    } else if (value < -INT16_MAX) {
+        return -INT16_MAX;
+    }
+    return (int16_t)value;
+}
+
+// out += a x b, all Q15
+static void add_cross(int32_t out[3], const int16_t a[3], const int32_t b[3]) {
+    out[0] += (a[1] * b[2] - a[2] * b[1]) >> 15;
+    out[1] += (a[2] * b[0] - a[0] * b[2]) >> 15;
+    out[2] += (a[0] * b[1] - a[1] * b[0]) >> 15;
+}
+
+void ahrs_init(int period_ms, const int16_t acc[3], const int16_t mag[3]) {
+    int16_t roll, pitch;
+
+    // pi / 180 / 65.6 / 2 / 1000 * 2^30 = 142.84 per ms
+    step = ((int32_t)period_ms * 14284 + 50) / 100;
+    integral[0] = integral[1] = integral[2] = 0;
+
+    // start from the accelerometer / magnetometer solution instead of converging to it
+    tilt_angles(acc, &roll, &pitch);
+    int16_t yaw = -tilt_heading(mag, acc);
+    int32_t cr = fx_cos(roll / 2), sr = fx_sin(roll / 2);
+    int32_t cp = fx_cos(pitch / 2), sp = fx_sin(pitch / 2);
+    int32_t cy = fx_cos(yaw / 2), sy = fx_sin(yaw / 2);
+    q[0] = (((cr * cp) >> 15) * cy + ((sr * sp) >> 15) * sy);
+    q[1] = (((sr * cp) >> 15) * cy - ((cr * sp) >> 15) * sy);
+    q[2] = (((cr * sp) >> 15) * cy + ((sr * cp) >> 15) * sy);
+    q[3] = (((cr * cp) >> 15) * sy - ((sr * sp) >> 15) * cy);
+}
+
+void ahrs_update(const int16_t gyro[3], const int16_t acc[3], const int16_t mag[3]) {
+    int32_t r[3][3];
+    int32_t error[3] = {0, 0, 0};
+    int16_t unit[3];
+    int32_t g[3];
+
+    rotation(r);
+
+    // gravity: measured direction against the one predicted by q
+    if (fx_normalize3(acc, unit)) {
+        int32_t v[3] = {r[2][0], r[2][1], r[2][2]};
+        add_cross(error, unit, v);
+    }
+    // magnetic field: predicted from the earth frame field with no east component
+    if (fx_normalize3(mag, unit)) {
+        int32_t h[3], w[3];
+        for (int i = 0; i < 3; i++) {
+            h[i] = (r[i][0] * unit[0] + r[i][1] * unit[1] + r[i][2] * unit[2]) >> 15;
+        }
+        int32_t bx = fx_sqrt(h[0] * h[0] + h[1] * h[1]);
+        int32_t bz = h[2];
+        for (int i = 0; i < 3; i++) {
+            w[i] = (r[0][i] * bx + r[2][i] * bz) >> 15;
+        }
+        add_cross(error, unit, w);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        integral[i] += error[i] * AHRS_KI_RAW;
+        if (integral[i] > AHRS_INTEGRAL_LIMIT) {
+            integral[i] = AHRS_INTEGRAL_LIMIT;
+        } else if (integral[i] < -AHRS_INTEGRAL_LIMIT) {
+            integral[i] = -AHRS_INTEGRAL_LIMIT;
+        }
+        g[i] = sat16(gyro[i] + ((error[i] * AHRS_KP_RAW) >> 15) + (integral[i] >> 15));
+    }
+
+    // q += q * (0, g) * step, where step already holds the 1/2
+    int32_t w = q[0] >> 15, x = q[1] >> 15, y = q[2] >> 15, z = q[3] >> 15;
+    int32_t dw = -x * g[0] - y * g[1] - z * g[2];
+    int32_t dx = w * g[0] + y * g[2] - z * g[1];
+    int32_t dy = w * g[1] - x * g[2] + z * g[0];
+    int32_t dz = w * g[2] + x * g[1] - y * g[0];
+    q[0] += ((dw >> 12) * step) >> 3;
+    q[1] += ((dx >> 12) * step) >> 3;
+    q[2] += ((dy >> 12) * step) >> 3;
+    q[3] += ((dz >> 12) * step) >> 3;
+
+    // first order renormalisation: q *= (3 - |q|^2) / 2
+    int32_t norm2 = 0;
+    for (int i = 0; i < 4; i++) {
+        int32_t c = q[i] >> 15;
+        norm2 += c * c;
+    }
+    int32_t delta = ((1L << 30) - norm2) / 2;
+    if (delta > (1L << 20)) {
+        delta = 1L << 20;
+    } else if (delta < -(1L << 20)) {
+        delta = -(1L << 20);
+    }
+    for (int i = 0; i < 4; i++) {
+        q[i] += ((q[i] >> 15) * (delta >> 8)) >> 7;
+    }
+}
+
+void ahrs_euler(int16_t *roll, int16_t *pitch, int16_t *yaw) {
+    int32_t r[3][3];
+    rotation(r);
+    int32_t horizontal = fx_sqrt(r[2][1] * r[2][1] + r[2][2] * r[2][2]);
+    *roll = fx_atan2(sat16(r[2][1]), sat16(r[2][2]));
+    *pitch = fx_atan2(sat16(-r[2][0]), sat16(horizontal));
+    *yaw = fx_atan2(sat16(r[1][0]), sat16(r[0][0]));
+}
+
+void ahrs_quaternion(int32_t out[4]) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = q[i];
+    }
+}
@@ -0,0 +1,42 @@
+/* 
+ * File:   ahrs.h
+ * Author: EMBG2
+ * Comments: Mahony orientation filter in fixed point.
+ *           The quaternion is kept in Q30 (int32) and every product is
+ *           16x16->32, so one update costs a few hundred instructions
+ *           and fits in the main loop period on the 16 bit core.
+ * Revision history: 
+ */
+
+#ifndef AHRS_H
+#define	AHRS_H
+
+#include <stdint.h>
+
+#define GYRO_RAW_PER_RAD_S 3758L // BMX055 gyro in the +-500 dps range, 65.6 LSB/dps
+#define AHRS_KP_RAW 3758L        // Kp = 1 rad/s per unit of error, in gyro LSB
+#define AHRS_KI_RAW 1L           // Ki of about 0.02 1/s^2 at 100 Hz
+#define AHRS_INTEGRAL_LIMIT (300L << 15) // bias estimate limit, about 4.6 dps
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+// period_ms is the update period, up to 30 ms. acc and mag set the initial orientation
+void ahrs_init(int period_ms, const int16_t acc[3], const int16_t mag[3]);
+// gyro in LSB of the +-500 dps range, acc and mag in any consistent unit
+void ahrs_update(const int16_t gyro[3], const int16_t acc[3], const int16_t mag[3]);
+// Euler angles (aerospace ZYX convention) as binary angles
+void ahrs_euler(int16_t *roll, int16_t *pitch, int16_t *yaw);
+// quaternion w, x, y, z in Q30
+void ahrs_quaternion(int32_t out[4]);
+
+// cost of ahrs_update() in instruction cycles, measured by the main loop
+extern uint32_t ahrs_cycles_last;
+extern uint32_t ahrs_cycles_max;
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* AHRS_H */
@@ -1,32 +1,45 @@
 #include "buffer.h"
 #include "xc.h"
 
-CircularBuffer main_buffer_1;
-CircularBuffer main_buffer_2;
-CircularBuffer transmit_buffer1;
-CircularBuffer transmit_buffer2;
+CIRCULAR_BUFFER(main_buffer_1, RX_BUFFER_SIZE);
+CIRCULAR_BUFFER(main_buffer_2, RX_BUFFER_SIZE);
+CIRCULAR_BUFFER(transmit_buffer1, TX_BUFFER_SIZE);
+CIRCULAR_BUFFER(transmit_buffer2, TX_BUFFER_SIZE);
 
-void buffer_init(CircularBuffer *buffer, char **patterns, int pattern_count)
+void buffer_init(CircularBuffer *buffer)
 {
     buffer->head = 0;
     buffer->tail = 0;
     buffer->count = 0;
-    buffer->patterns = patterns;
-    buffer->pattern_count = pattern_count;
+    buffer->high_water = 0;
+}
+
+void pattern_detector_init(PatternDetector *detector, CircularBuffer *buffer, char **patterns, int pattern_count)
+{
+    detector->buffer = buffer;
+    detector->patterns = patterns;
+    detector->pattern_count = pattern_count;
     for (int i = 0; i < pattern_count; i++) {
-        buffer->flags[i] = 0;
+        detector->flags[i] = 0;
     }
 }
 
 int buffer_write(CircularBuffer *buffer, char value)
 {
-    if (buffer->count == MAIN_BUFFER_SIZE)
+    if (buffer->count == buffer->size)
     {
         return 0;
     }
     buffer->data[buffer->tail] = value;
-    buffer->tail = (buffer->tail + 1) % MAIN_BUFFER_SIZE;
+    if (++buffer->tail == buffer->size)
+    {
+        buffer->tail = 0;
+    }
     buffer->count++;
+    if (buffer->count > buffer->high_water)
+    {
+        buffer->high_water = buffer->count;
+    }
     return 1;
 }
 
@@ -37,7 +50,10 @@ int buffer_read(CircularBuffer *buffer, char *value)
         return 0;
     }
     *value = buffer->data[buffer->head];
-    buffer->head = (buffer->head + 1) % MAIN_BUFFER_SIZE;
+    if (++buffer->head == buffer->size)
+    {
+        buffer->head = 0;
+    }
     buffer->count--;
     return 1;
 }
@@ -48,7 +64,79 @@ int buffer_peek(const CircularBuffer *buffer, int index)
     {
         return -1;
     }
-    return buffer->data[(buffer->head + index) % MAIN_BUFFER_SIZE];
+    index += buffer->head;
+    if (index >= buffer->size)
+    {
+        index -= buffer->size;
+    }
+    return buffer->data[index];
+}
+
+int buffer_free(const CircularBuffer *buffer)
+{
+    return buffer->size - buffer->count;
+}
+
+int buffer_span(const CircularBuffer *buffer, char **data)
+{
+    int n = buffer->size - buffer->head;
+    *data = &buffer->data[buffer->head];
+    return (buffer->count < n) ? buffer->count : n;
+}
+
+void buffer_consume(CircularBuffer *buffer, int n)
+{
+    buffer->head += n;
+    if (buffer->head >= buffer->size)
+    {
+        buffer->head -= buffer->size;
+    }
+    buffer->count -= n;
+}
+
+int buffer_drop_line(CircularBuffer *buffer, int keep)
+{
+    int len = 0;
+    while (keep + len < buffer->count && buffer_peek(buffer, keep + len) != '\n')
+    {
+        len++;
+    }
+    if (keep + len == buffer->count)
+    {
+        return 0; // no complete line after the kept bytes
+    }
+    len++;
+    // move the kept bytes forward over the dropped line, last byte first;
+    // indices wrap with a compare, a division costs 18 cycles here
+    int from = buffer->head + keep - 1;
+    int to = from + len;
+    if (from >= buffer->size)
+    {
+        from -= buffer->size;
+    }
+    if (to >= buffer->size)
+    {
+        to -= buffer->size;
+    }
+    for (int i = 0; i < keep; i++)
+    {
+        buffer->data[to] = buffer->data[from];
+        if (--from < 0)
+        {
+            from = buffer->size - 1;
+        }
+        if (--to < 0)
+        {
+            to = buffer->size - 1;
+        }
+    }
+    buffer->head += len;
+    if (buffer->head >= buffer->size)
+    {
+        buffer->head -= buffer->size;
+    }
+    buffer->count -= len;
+    return len;
 }
 
 void uart_debug_send(char c) {
@@ -56,16 +144,17 @@ void uart_debug_send(char c) {
     U1TXREG = c;
 }
 
-void detect_pattern(CircularBuffer *buffer)
+void detect_pattern(PatternDetector *detector)
 {
+    CircularBuffer *buffer = detector->buffer;
     char temp[10];
     int match_found = 0;
     while (buffer->count > 2)
     {
-        for (int i = 0; i < buffer->pattern_count; i++)
+        for (int i = 0; i < detector->pattern_count; i++)
         {
             int pattern_len = 0;
-            while (buffer->patterns[i][pattern_len] != '\0')
+            while (detector->patterns[i][pattern_len] != '\0')
             {
                 pattern_len++;
             }
@@ -75,7 +164,7 @@ void detect_pattern(CircularBuffer *buffer)
 
             for (; j < pattern_len; j++)
             {
-                if (buffer_peek(buffer, j) != buffer->patterns[i][j])
+                if (buffer_peek(buffer, j) != detector->patterns[i][j])
                 {
                     valid_pattern = 0;
                     break;
@@ -88,7 +177,7 @@ void detect_pattern(CircularBuffer *buffer)
                 {
                     buffer_read(buffer, &temp[k]);
                 }
-                buffer->flags[i] = 1;
+                detector->flags[i] = 1;
                 match_found = 1;
                 break;
             }
@@ -4,26 +4,49 @@
 #include "timer.h"
 #include <xc.h> 
 
-#define MAIN_BUFFER_SIZE 100
-#define SECONDARY_BUFFER_SIZE 5
+#define RX_BUFFER_SIZE 64
+#define TX_BUFFER_SIZE 160
 #define MAX_PATTERN_COUNT 10
 
 typedef struct
 {
-    char data[MAIN_BUFFER_SIZE];
+    char *data;
+    int size;
     int head;
     int tail;
     int count;
+    int high_water; // largest count seen since buffer_init
+} CircularBuffer;
+
+// defines a CircularBuffer called name with its own storage of capacity bytes
+#define CIRCULAR_BUFFER(name, capacity) \
+    static char name##_data[capacity]; \
+    CircularBuffer name = { name##_data, capacity, 0, 0, 0, 0 }
+
+typedef struct
+{
+    CircularBuffer *buffer;
     int pattern_count;
     char **patterns;   // Array of patterns to detect
     int flags[MAX_PATTERN_COUNT];
-} CircularBuffer;
+} PatternDetector;
 
-void buffer_init(CircularBuffer *buffer, char **patterns, int pattern_count);
+void buffer_init(CircularBuffer *buffer);
 int buffer_write(CircularBuffer *buffer, char value);
 int buffer_read(CircularBuffer *buffer, char *value);
 int buffer_peek(const CircularBuffer *buffer, int index);
-void detect_pattern(CircularBuffer *buffer);
+int buffer_free(const CircularBuffer *buffer);
+// sets *data to the oldest byte and returns how many bytes follow it
+// contiguously, up to the end of the storage. buffer_consume releases them
+int buffer_span(const CircularBuffer *buffer, char **data);
+void buffer_consume(CircularBuffer *buffer, int n);
+// removes the first '\n' terminated line starting at or after index keep,
+// the first keep bytes stay in front. Returns the number of bytes removed
+int buffer_drop_line(CircularBuffer *buffer, int keep);
+void pattern_detector_init(PatternDetector *detector, CircularBuffer *buffer, char **patterns, int pattern_count);
+void detect_pattern(PatternDetector *detector);
+// blocking write straight to U1TXREG, bypassing transmit_buffer1
+void uart_debug_send(char c);
 
 extern CircularBuffer main_buffer_1;
 extern CircularBuffer main_buffer_2;
@@ -0,0 +1,80 @@
+#include "calib.h"
+#include "dsp.h"
+
+mag_calibration mag_cal;
+
+static int calib_active = 0;
+static int16_t range_min[3];
+static int16_t range_max[3];
+
+void calib_init(void) {
+    for (int i = 0; i < 3; i++) {
+        mag_cal.offset[i] = 0;
+        for (int j = 0; j < 3; j++) {
+            mag_cal.matrix[i][j] = (i == j) ? Q15_ONE : 0;
+        }
+    }
+}
+
+void calib_apply(const mag_calibration *cal, const int16_t raw[3], int16_t out[3]) {
+    int16_t centered[3];
+    for (int i = 0; i < 3; i++) {
+        centered[i] = raw[i] - cal->offset[i];
+    }
+    // three MACs per row, rounded and saturated on the store; rounding
+    // makes Q15_ONE exact for |x| < 16384
+    for (int i = 0; i < 3; i++) {
+        out[i] = dsp_dot_q15(cal->matrix[i], centered, 3);
+    }
+}
+
+void calib_start(void) {
+    for (int i = 0; i < 3; i++) {
+        range_min[i] = INT16_MAX;
+        range_max[i] = INT16_MIN;
+    }
+    calib_active = 1;
+}
+
+void calib_update(const int16_t raw[3]) {
+    for (int i = 0; i < 3; i++) {
+        if (raw[i] < range_min[i]) {
+            range_min[i] = raw[i];
+        }
+        if (raw[i] > range_max[i]) {
+            range_max[i] = raw[i];
+        }
+    }
+}
+
+int calib_stop(void) {
+    int16_t radius[3];
+    int16_t smallest = INT16_MAX;
+
+    calib_active = 0;
+    for (int i = 0; i < 3; i++) {
+        radius[i] = (range_max[i] > range_min[i]) ? ((int32_t)range_max[i] - range_min[i]) / 2 : 0;
+        if (radius[i] >= CAL_MIN_RADIUS && radius[i] < smallest) {
+            smallest = radius[i];
+        }
+    }
+    if (smallest == INT16_MAX) {
+        return 0;
+    }
+    // scale every axis down to the smallest radius so the gains stay below 1.0 in Q15
+    for (int i = 0; i < 3; i++) {
+        if (radius[i] < CAL_MIN_RADIUS) {
+            continue; // e.g. z when the board was only turned flat on the table
+        }
+        mag_cal.offset[i] = ((int32_t)range_max[i] + range_min[i]) / 2;
+        for (int j = 0; j < 3; j++) {
+            mag_cal.matrix[i][j] = 0;
+        }
+        mag_cal.matrix[i][i] = (radius[i] == smallest) ? Q15_ONE : (int16_t)(((int32_t)smallest << 15) / radius[i]);
+    }
+    return 1;
+}
+
+int calib_running(void) {
+    return calib_active;
+}
@@ -0,0 +1,44 @@
+/* 
+ * File:   calib.h
+ * Author: EMBG2
+ * Comments: hard/soft-iron magnetometer calibration in Q15 fixed point.
+ *           corrected = M * (raw - offset), with M a 3x3 Q15 matrix.
+ *           The online estimator only tracks per-axis min/max, so it
+ *           needs no sample storage and a few compares per sample.
+ * Revision history: 
+ */
+
+#ifndef CALIB_H
+#define	CALIB_H
+
+#include <stdint.h>
+
+#define Q15_ONE 32767
+#define CAL_MIN_RADIUS 50 // LSB, axes with a smaller half range are left uncalibrated
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int16_t offset[3];    // hard-iron offset, LSB
+    int16_t matrix[3][3]; // soft-iron correction, Q15
+} mag_calibration;
+
+extern mag_calibration mag_cal;
+
+// resets mag_cal to zero offset and identity matrix
+void calib_init(void);
+void calib_apply(const mag_calibration *cal, const int16_t raw[3], int16_t out[3]);
+
+void calib_start(void);
+void calib_update(const int16_t raw[3]);
+// computes a new mag_cal from the collected range, returns 0 if the range was too small
+int calib_stop(void);
+int calib_running(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* CALIB_H */
@@ -0,0 +1,133 @@
+#include "xc.h"
+#include "capture.h"
+#include "buffer.h"
+#include "txq.h"
+#include "uart.h"
+#include <stdio.h>
+
+// the buffer is larger than the RAM left below 0x8000, it goes to the
+// upper 24 KB that is only reached through the EDS page window: every
+// access goes through an __eds__ pointer, which sets DSRPAG
+#ifdef __XC16__
+#define CAPTURE_EDS __eds__
+#define CAPTURE_EDS_SPACE __attribute__((eds, space(eds)))
+#else
+#define CAPTURE_EDS
+#define CAPTURE_EDS_SPACE
+#endif
+
+static CAPTURE_EDS capture_record records[CAPTURE_RECORDS] CAPTURE_EDS_SPACE;
+static volatile int mode = CAPTURE_OFF;
+static unsigned int head = 0;   // next record written
+static unsigned int count = 0;
+
+// dump progress, owned by the TX interrupt once dumping is set
+static volatile int dumping = 0;
+static unsigned int dump_index;  // records sent
+static int dump_byte;            // next byte inside the record, -1 for the header
+static uint16_t dump_sum;
+
+int capture_start(int new_mode) {
+    if (dumping) {
+        return 0;
+    }
+    mode = CAPTURE_OFF;
+    head = 0;
+    count = 0;
+    mode = new_mode;
+    return 1;
+}
+
+void capture_stop(void) {
+    mode = CAPTURE_OFF;
+}
+
+int capture_mode(void) {
+    return mode;
+}
+
+unsigned int capture_count(void) {
+    return count;
+}
+
+void capture_sample(uint32_t t_us, const uint8_t raw[6]) {
+    if (mode == CAPTURE_OFF) {
+        return;
+    }
+    CAPTURE_EDS capture_record *r = &records[head];
+    r->t_us = t_us;
+    for (int i = 0; i < 6; i++) {
+        r->raw[i] = raw[i];
+    }
+    if (++head == CAPTURE_RECORDS) {
+        head = 0;
+    }
+    if (count < CAPTURE_RECORDS) {
+        count++;
+        if (count == CAPTURE_RECORDS && mode == CAPTURE_ONESHOT) {
+            mode = CAPTURE_OFF;
+        }
+    }
+}
+
+int capture_dump_start(void) {
+    if (dumping) {
+        return 0;
+    }
+    mode = CAPTURE_OFF;
+    dump_index = 0;
+    dump_byte = -1;
+    dump_sum = 0;
+    txq_hold(UART_1, 1); // no text line may land in the middle of the records
+    dumping = 1;
+    uart_tx_interrupt_enable(UART_1, 1);
+    return 1;
+}
+
+int capture_dumping(void) {
+    return dumping;
+}
+
+// copies a whole line into the transmit buffer, or nothing if it does not fit yet
+static int dump_line(const char *line, int len) {
+    if (buffer_free(&transmit_buffer1) < len) {
+        return 0;
+    }
+    for (int i = 0; i < len; i++) {
+        buffer_write(&transmit_buffer1, line[i]);
+    }
+    return 1;
+}
+
+void capture_dump_pump(void) {
+    char line[24];
+    if (!dumping) {
+        return;
+    }
+    if (dump_byte < 0) {
+        if (!dump_line(line, sprintf(line, "$DUMP,%u,%d*\n", count, CAPTURE_RECORD_BYTES))) {
+            return;
+        }
+        dump_byte = 0;
+    }
+    // oldest record first
+    unsigned int first = (count == CAPTURE_RECORDS) ? head : 0;
+    while (dump_index < count && buffer_free(&transmit_buffer1) > 0) {
+        unsigned int index = first + dump_index;
+        if (index >= CAPTURE_RECORDS) {
+            index -= CAPTURE_RECORDS;
+        }
+        const CAPTURE_EDS capture_record *r = &records[index];
+        uint8_t b = (dump_byte < 4) ? (uint8_t)(r->t_us >> (8 * dump_byte)) : r->raw[dump_byte - 4];
+        buffer_write(&transmit_buffer1, (char)b);
+        dump_sum += b;
+        if (++dump_byte == CAPTURE_RECORD_BYTES) {
+            dump_byte = 0;
+            dump_index++;
+        }
+    }
+    if (dump_index == count && dump_line(line, sprintf(line, "$DUMP,END,%u*\n", dump_sum))) {
+        dumping = 0;
+        txq_hold(UART_1, 0);
+    }
+}
@@ -0,0 +1,57 @@
+/* 
+ * File:   capture.h
+ * Author: EMBG2
+ * Comments: RAM capture of the raw magnetometer registers, one record
+ *           per spi_read_multiple(), for looking at the full rate input
+ *           of the filter offline. $DUMP streams the records out in
+ *           binary from the TX interrupt, UART1 telemetry is held back
+ *           until the dump is over.
+ *
+ *           Dump format:
+ *             "$DUMP,<records>,<record size>*\n"
+ *             records x { t_us: uint32 little endian, raw: 6 bytes from 0x42 }
+ *             "$DUMP,END,<16-bit sum of all record bytes>*\n"
+ * Revision history: 
+ */
+
+#ifndef CAPTURE_H
+#define	CAPTURE_H
+
+#include <stdint.h>
+
+#define CAPTURE_RECORDS 2400   // 24000 bytes, the RAM above 0x8000 (EDS) is 24 KB
+#define CAPTURE_RECORD_BYTES 10
+
+// capture modes
+#define CAPTURE_OFF 0
+#define CAPTURE_ONESHOT 1 // stops when the buffer is full
+#define CAPTURE_RING 2    // keeps the newest CAPTURE_RECORDS samples
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t t_us;   // now_us() at acquisition
+    uint8_t raw[6];  // registers 0x42..0x47 as read
+} capture_record;
+
+// returns 0 while a dump is in progress
+int capture_start(int mode);
+void capture_stop(void);
+int capture_mode(void);
+unsigned int capture_count(void);
+// called once per magnetometer read, a few word copies when capturing
+void capture_sample(uint32_t t_us, const uint8_t raw[6]);
+
+// stops capturing and starts streaming the records, returns 0 if a dump is already running
+int capture_dump_start(void);
+int capture_dumping(void);
+// UART1 TX interrupt: refills transmit_buffer1 while a dump is running
+void capture_dump_pump(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* CAPTURE_H */
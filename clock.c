@@ -0,0 +1,62 @@
+#include "xc.h"
+#include "clock.h"
+#include "prof.h"
+
+// microseconds at the start of the current timer period, counted by the
+// Timer5 interrupt
+static volatile uint32_t epoch_us = 0;
+
+void clock_init(void) {
+    T4CONbits.TON = 0;
+    T4CONbits.T32 = 1;              // Timer4 and Timer5 form one 32-bit timer
+    T4CONbits.TCKPS = 1;            // 1:8 prescaler, 9 ticks per microsecond
+    TMR5 = 0;                       // TMR5 is written first, then TMR4
+    TMR4 = 0;
+    PR5 = (unsigned int)((CLOCK_EPOCH_TICKS - 1) >> 16);
+    PR4 = (unsigned int)((CLOCK_EPOCH_TICKS - 1) & 0xFFFF);
+    epoch_us = 0;
+    IFS1bits.T5IF = 0;              // the 32-bit timer interrupts through Timer5
+    IEC1bits.T5IE = 1;
+    T4CONbits.TON = 1;
+}
+
+// ticks / 9 with two 32 by 16 bit divisions, both quotients fit in 16 bits
+static uint32_t ticks_to_us(uint32_t ticks) {
+#ifdef __XC16__
+    unsigned int high = (unsigned int)(ticks >> 16);
+    unsigned int q_high = high / CLOCK_TICKS_PER_US;
+    uint32_t rest = ((uint32_t)(high - q_high * CLOCK_TICKS_PER_US) << 16) | (ticks & 0xFFFF);
+    return ((uint32_t)q_high << 16) + __builtin_divud(rest, CLOCK_TICKS_PER_US);
+#else
+    return ticks / CLOCK_TICKS_PER_US;
+#endif
+}
+
+uint32_t now_us(void) {
+    uint32_t epoch, ticks;
+    int pending, saved_ipl;
+    // every interrupt is held off for the few reads: the RX and TX ones call
+    // now_us() too, and their TMR4 read would relatch TMR5HLD between ours;
+    // the Timer5 one would move epoch_us
+    SET_AND_SAVE_CPU_IPL(saved_ipl, 7);
+    epoch = epoch_us;
+    ticks = TMR4;                               // reading TMR4 latches TMR5 into TMR5HLD
+    ticks |= (uint32_t)TMR5HLD << 16;
+    pending = IFS1bits.T5IF;
+    RESTORE_CPU_IPL(saved_ipl);
+    // the period ended but the interrupt has not run yet (or cannot, when the
+    // caller runs at a higher priority): a small count belongs to the next period
+    if (pending && ticks < CLOCK_EPOCH_TICKS / 2) {
+        epoch += CLOCK_EPOCH_US;
+    }
+    return epoch + ticks_to_us(ticks);
+}
+
+void __attribute__((__interrupt__, auto_psv)) _T5Interrupt(void) {
+    PROF_ISR_ENTER(T5);
+    uint16_t late = TMR4; // low word of the restarted 32-bit count, 8 cycles per tick
+    PROF_ISR_LATENCY(T5, late < 8192 ? late * 8 : 0xFFFF);
+    IFS1bits.T5IF = 0;
+    epoch_us += CLOCK_EPOCH_US;
+    PROF_ISR_EXIT(T5);
+}
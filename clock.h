@@ -0,0 +1,31 @@
+/* 
+ * File:   clock.h
+ * Author: EMBG2
+ * Comments: free-running microsecond timebase on Timer4/5 chained as one
+ *           32-bit timer. now_us() wraps every 2^32 us (about 71 minutes),
+ *           differences between two readings stay valid across the wrap.
+ * Revision history: 
+ */
+
+#ifndef CLOCK_H
+#define	CLOCK_H
+
+#include <stdint.h>
+
+#define CLOCK_TICKS_PER_US 9 // FCY / 8
+// the 32-bit timer restarts every 400 s, a whole number of microseconds
+#define CLOCK_EPOCH_US 400000000UL
+#define CLOCK_EPOCH_TICKS (CLOCK_EPOCH_US * CLOCK_TICKS_PER_US)
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+void clock_init(void);
+uint32_t now_us(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* CLOCK_H */
@@ -0,0 +1,238 @@
+#include "command.h"
+#include "uart.h"
+#include "buffer.h"
+#include "trace.h"
+#include "txq.h"
+#include "calib.h"
+#include "ahrs.h"
+#include "heading.h"
+#include "magacq.h"
+#include "timesync.h"
+#include "capture.h"
+#include "stats.h"
+#include "prof.h"
+#include "route.h"
+#include "magz.h"
+#include "rategen.h"
+#include "shed.h"
+#include "dspcost.h"
+#include <stdio.h>
+#include <string.h>
+
+parser_state ps_1;
+parser_state ps_2;
+rate_gen mag_rate[2];
+volatile int timestamps_enabled = 0;
+
+static char reply[120]; // fits the echo of a full 100 byte payload
+
+static void send_calibration(unsigned char uart) {
+    const mag_calibration *c = &mag_cal;
+    sprintf(reply, "$CAL,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d*\n",
+            c->offset[0], c->offset[1], c->offset[2],
+            c->matrix[0][0], c->matrix[0][1], c->matrix[0][2],
+            c->matrix[1][0], c->matrix[1][1], c->matrix[1][2],
+            c->matrix[2][0], c->matrix[2][1], c->matrix[2][2]);
+    txq_send(uart, TXQ_PRIO_HIGH, reply);
+}
+
+static void parser_init(parser_state *ps) {
+    ps->state = STATE_DOLLAR;
+    ps->index_type = 0; 
+    ps->index_payload = 0;
+    ps->resets = 0;
+}
+
+void command_init(void) {
+    parser_init(&ps_1);
+    parser_init(&ps_2);
+    rategen_set(&mag_rate[0], MAG_DEFAULT_RATE_MHZ);
+    rategen_set(&mag_rate[1], MAG_DEFAULT_RATE_MHZ);
+}
+
+void process_uart(unsigned char uart) {
+    CircularBuffer *rx = (uart == UART_1) ? &main_buffer_1 : &main_buffer_2;
+    parser_state *ps = (uart == UART_1) ? &ps_1 : &ps_2;
+    uint32_t frame_us = 0;
+    char *span;
+    int len, used;
+    // one contiguous span of the ring at a time, without taking the bytes
+    // out one by one. The ring is only read, the message is copied out
+    while ((len = buffer_span(rx, &span)) > 0) {
+        int found = parse_bytes(ps, span, len, &used);
+        if (uart == UART_1) {
+            frame_us = timesync_rx_span(ps->frame_start, used); // receive stamps exist for UART1 only
+        }
+        if (found == NEW_MESSAGE) {
+            sprintf(reply, "$MSG,%s,%s*\n", ps->msg_type, ps->msg_payload);
+            txq_send(uart, TXQ_PRIO_HIGH, reply);
+            stats_count_type(ps->msg_type);
+            if (strcmp(ps->msg_type, "RATE") == 0) {
+                long new_rate = extract_millis(ps->msg_payload); // Hz with up to three decimals
+                if (new_rate >= 0 && rategen_set(&mag_rate[UART_INDEX(uart)], new_rate)) {
+                    if (new_rate % 1000 == 0) {
+                        sprintf(reply, "$NEW_RATE,%ld*\n", new_rate / 1000);
+                    } else {
+                        sprintf(reply, "$NEW_RATE,%ld.%03ld*\n", new_rate / 1000, new_rate % 1000);
+                    }
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            } else if (strcmp(ps->msg_type, "SYNC") == 0) {
+                if (uart == UART_1) {
+                    timesync_request(ps->msg_payload, frame_us, reply);
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,2*\n");
+                }
+            } else if (strcmp(ps->msg_type, "CAP") == 0) {
+                int ok = 1;
+                if (strcmp(ps->msg_payload, "START") == 0) {
+                    ok = capture_start(CAPTURE_ONESHOT);
+                } else if (strcmp(ps->msg_payload, "RING") == 0) {
+                    ok = capture_start(CAPTURE_RING);
+                } else if (strcmp(ps->msg_payload, "STOP") == 0) {
+                    capture_stop();
+                } else if (strcmp(ps->msg_payload, "GET") != 0) {
+                    ok = -1;
+                }
+                if (ok == 1) {
+                    sprintf(reply, "$CAP,%d,%u*\n", capture_mode(), capture_count());
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, ok < 0 ? "$ERR,1*\n" : "$ERR,2*\n");
+                }
+            } else if (strcmp(ps->msg_type, "DUMP") == 0) {
+                // binary on UART1 only, one at a time with $TRACE,DUMP
+                if (uart != UART_1 || trace_dumping() || !capture_dump_start()) {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,2*\n");
+                }
+            } else if (strcmp(ps->msg_type, "STAT") == 0) {
+                if (ps->msg_payload[0] == '\0') {
+                    stats_format(reply);
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else if (strcmp(ps->msg_payload, "2") == 0) {
+                    stats_format_uart2(reply);
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else if (strcmp(ps->msg_payload, "TYPES") == 0) {
+                    stats_format_types(reply);
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else if (strcmp(ps->msg_payload, "RESET") == 0) {
+                    stats_reset();
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            } else if (strcmp(ps->msg_type, "PROF") == 0) {
+                if (ps->msg_payload[0] == '\0') {
+                    for (int i = 0; i < PROF_ISR_COUNT; i++) {
+                        prof_format(reply, i);
+                        txq_send(uart, TXQ_PRIO_HIGH, reply);
+                    }
+                } else if (strcmp(ps->msg_payload, "RESET") == 0) {
+                    prof_reset();
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            } else if (strcmp(ps->msg_type, "SHED") == 0) {
+                if (ps->msg_payload[0] == '\0') {
+                    shed_format(reply);
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            } else if (strcmp(ps->msg_type, "ROUTE") == 0) {
+                int i = next_value(ps->msg_payload, 0);
+                int stream = route_find(ps->msg_payload);
+                if (stream < 0) {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                } else {
+                    if (ps->msg_payload[i] != '\0') {
+                        routes[stream] = extract_integer(ps->msg_payload + i) & ROUTE_ALL;
+                    }
+                    sprintf(reply, "$ROUTE,%s,%d*\n", route_names[stream], routes[stream]);
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                }
+            } else if (strcmp(ps->msg_type, "TS") == 0) {
+                if (strcmp(ps->msg_payload, "0") == 0 || strcmp(ps->msg_payload, "1") == 0) {
+                    timestamps_enabled = ps->msg_payload[0] - '0';
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            } else if (strcmp(ps->msg_type, "MZ") == 0) {
+                if (strcmp(ps->msg_payload, "0") == 0 || strcmp(ps->msg_payload, "1") == 0) {
+                    magz_enabled = ps->msg_payload[0] - '0';
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            } else if (strcmp(ps->msg_type, "TRACE") == 0) {
+                if (strcmp(ps->msg_payload, "START") == 0) {
+                    if (!trace_start()) {
+                        txq_send(uart, TXQ_PRIO_HIGH, "$ERR,2*\n");
+                    }
+                } else if (strcmp(ps->msg_payload, "STOP") == 0) {
+                    trace_stop();
+                } else if (strcmp(ps->msg_payload, "DUMP") == 0) {
+                    // the dump goes out on UART1 only, one at a time with $DUMP
+                    if (uart != UART_1 || capture_dumping() || !trace_dump_start()) {
+                        txq_send(uart, TXQ_PRIO_HIGH, "$ERR,2*\n");
+                    }
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            } else if (strcmp(ps->msg_type, "CAL") == 0) {
+                if (strcmp(ps->msg_payload, "START") == 0) {
+                    calib_start();
+                } else if (strcmp(ps->msg_payload, "STOP") == 0) {
+                    if (calib_stop()) {
+                        send_calibration(uart);
+                    } else {
+                        txq_send(uart, TXQ_PRIO_HIGH, "$ERR,2*\n"); // not enough rotation
+                    }
+                } else if (strcmp(ps->msg_payload, "GET") == 0) {
+                    send_calibration(uart);
+                } else if (strcmp(ps->msg_payload, "RESET") == 0) {
+                    calib_init();
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            } else if (strcmp(ps->msg_type, "ODR") == 0) {
+                if (strcmp(ps->msg_payload, "COST") == 0) {
+                    sprintf(reply, "$ODR,COST,%lu,%lu,%lu,%lu*\n",
+                            (unsigned long)magacq_cycles_max[0], (unsigned long)magacq_cycles_max[1],
+                            (unsigned long)magacq_cycles_max[2], (unsigned long)magacq_cycles_max[3]);
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else if (ps->msg_payload[0] >= '0' && ps->msg_payload[0] <= '9'
+                           && magacq_set_mode(extract_integer(ps->msg_payload))) {
+                    const mag_acq_mode *m = &mag_acq_modes[magacq_mode()];
+                    sprintf(reply, "$ODR,%d,%d,%d*\n", magacq_mode(), m->odr_hz, 1 << m->decimation_log2);
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            } else if (strcmp(ps->msg_type, "DSP") == 0) {
+                if (strcmp(ps->msg_payload, "COST") == 0) {
+                    dspcost_format(reply);
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            } else if (strcmp(ps->msg_type, "HDG") == 0) {
+                if (strcmp(ps->msg_payload, "COST") == 0) {
+                    sprintf(reply, "$HDG,%lu,%lu*\n", (unsigned long)heading_cycles_last, (unsigned long)heading_cycles_max);
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            } else if (strcmp(ps->msg_type, "AHRS") == 0) {
+                if (strcmp(ps->msg_payload, "COST") == 0) {
+                    sprintf(reply, "$AHRS,%lu,%lu*\n", (unsigned long)ahrs_cycles_last, (unsigned long)ahrs_cycles_max);
+                    txq_send(uart, TXQ_PRIO_HIGH, reply);
+                } else {
+                    txq_send(uart, TXQ_PRIO_HIGH, "$ERR,1*\n");
+                }
+            }
+        }
+        buffer_consume(rx, used);
+    }
+}
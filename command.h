@@ -0,0 +1,34 @@
+/* 
+ * File:   command.h
+ * Author: EMBG2
+ * Comments: handling of the $-commands received on UART1 and UART2,
+ *           replies go back to the port the command came from
+ * Revision history: 
+ */
+
+#ifndef COMMAND_H
+#define	COMMAND_H
+
+#include "parser.h"
+#include "rategen.h"
+
+#define MAG_DEFAULT_RATE_MHZ 5000 // 5 Hz
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+extern parser_state ps_1;
+extern parser_state ps_2;
+extern rate_gen mag_rate[2]; // $MAG rate of each port, set by $RATE on that port (any rate up to the loop rate)
+extern volatile int timestamps_enabled; // append the sample time to $MAG and $YAW
+
+void command_init(void);
+// drains the receive buffer of uart and executes every complete command
+void process_uart(unsigned char uart);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* COMMAND_H */
@@ -0,0 +1,186 @@
+#include "xc.h"
+#include "dsp.h"
+#include <stddef.h>
+
+// Accumulator A, one statement per DSP instruction. The host version keeps
+// the 40-bit accumulator in an int64_t and applies the same saturation and
+// rounding, products are shifted left by one as in fractional mode
+#ifdef __XC16__
+#define ACC_DECLARE register int acc asm("A")
+#define ACC_CLR() acc = __builtin_clr()
+#define ACC_MPY(a, b) acc = __builtin_mpy((a), (b), NULL, NULL, 0, NULL, NULL, 0)
+#define ACC_MAC(a, b) acc = __builtin_mac(acc, (a), (b), NULL, NULL, 0, NULL, NULL, 0, NULL, 0)
+#define ACC_MSC(a, b) acc = __builtin_msc(acc, (a), (b), NULL, NULL, 0, NULL, NULL, 0, NULL, 0)
+#define ACC_SACR(shift) ((int16_t)__builtin_sacr(acc, (shift)))
+#else
+#define ACC_MAX (((int64_t)1 << 39) - 1)
+#define ACC_MIN (-((int64_t)1 << 39))
+#define ACC_DECLARE int64_t acc
+#define ACC_CLR() acc = 0
+#define ACC_MPY(a, b) acc = 2 * (int64_t)(a) * (b)
+#define ACC_MAC(a, b) acc = acc_saturate(acc + 2 * (int64_t)(a) * (b))
+#define ACC_MSC(a, b) acc = acc_saturate(acc - 2 * (int64_t)(a) * (b))
+#define ACC_SACR(shift) acc_store(acc, (shift))
+
+// 9.31 saturation
+static int64_t acc_saturate(int64_t acc) {
+    if (acc > ACC_MAX) {
+        return ACC_MAX;
+    }
+    if (acc < ACC_MIN) {
+        return ACC_MIN;
+    }
+    return acc;
+}
+
+// SAC.R: shift (right when positive), round on bit 15, saturate to 16 bits
+static int16_t acc_store(int64_t acc, int shift) {
+    acc = (shift >= 0) ? acc >> shift : acc * ((int64_t)1 << -shift);
+    acc = (acc + 0x8000) >> 16;
+    if (acc > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (acc < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)acc;
+}
+#endif
+
+void dsp_init(void) {
+#ifdef __XC16__
+    CORCONbits.US = 0;      // signed multiplies
+    CORCONbits.IF = 0;      // fractional mode, products are Q31
+    CORCONbits.RND = 1;     // conventional rounding, as the host version
+    CORCONbits.SATA = 1;    // accumulator A saturates
+    CORCONbits.ACCSAT = 1;  // at 9.31, partial sums can exceed 1.0
+    CORCONbits.SATDW = 1;   // stores saturate to 16 bits
+#endif
+}
+
+// a 16-bit add and a compare is already as fast as going through the accumulator
+void dsp_add_q15(int16_t *out, const int16_t *a, const int16_t *b, uint16_t n) {
+    for (uint16_t i = 0; i < n; i++) {
+        int32_t sum = (int32_t)a[i] + b[i];
+        if (sum > INT16_MAX) {
+            sum = INT16_MAX;
+        } else if (sum < INT16_MIN) {
+            sum = INT16_MIN;
+        }
+        out[i] = (int16_t)sum;
+    }
+}
+
+void dsp_scale_q15(int16_t *out, const int16_t *x, int16_t k, uint16_t n) {
+    ACC_DECLARE;
+    for (uint16_t i = 0; i < n; i++) {
+        ACC_MPY(x[i], k);
+        out[i] = ACC_SACR(0);
+    }
+}
+
+int16_t dsp_dot_q15(const int16_t *a, const int16_t *b, uint16_t n) {
+    ACC_DECLARE;
+    ACC_CLR();
+    for (uint16_t i = 0; i < n; i++) {
+        ACC_MAC(a[i], b[i]);
+    }
+    return ACC_SACR(0);
+}
+
+void dsp_fir_init(dsp_fir *f, const int16_t *coeffs, int16_t *delay, uint8_t taps) {
+    f->coeffs = coeffs;
+    f->delay = delay;
+    f->taps = taps;
+    f->index = 0;
+    for (uint8_t i = 0; i < taps; i++) {
+        delay[i] = 0;
+    }
+}
+
+int16_t dsp_fir_q15(dsp_fir *f, int16_t x) {
+    ACC_DECLARE;
+    const int16_t *h = f->coeffs;
+    int i = f->index;
+    f->delay[i] = x;
+    ACC_CLR();
+    // newest to oldest: back to the start of the line, then down from its end
+    for (int k = i; k >= 0; k--) {
+        ACC_MAC(*h++, f->delay[k]);
+    }
+    for (int k = f->taps - 1; k > i; k--) {
+        ACC_MAC(*h++, f->delay[k]);
+    }
+    f->index = (i + 1 == f->taps) ? 0 : i + 1;
+    return ACC_SACR(0);
+}
+
+int16_t dsp_fir_mod_q15(dsp_fir *f, int16_t x) {
+    int i = f->index;
+    int oldest = (i + 1 == f->taps) ? 0 : i + 1;
+    f->delay[i] = x;
+    f->index = oldest;
+#ifdef __XC16__
+    // oldest to newest through the delay line, h[taps - 1] down to h[0]
+    register int16_t *xp asm("w8") = &f->delay[oldest];
+    register const int16_t *yp asm("w10") = &f->coeffs[f->taps - 1];
+    int16_t out;
+    int saved_ipl;
+    // MODCON would also wrap W8 in an interrupt taken during the REPEAT
+    SET_AND_SAVE_CPU_IPL(saved_ipl, 7);
+    XMODSRT = (unsigned int)f->delay;
+    XMODEND = (unsigned int)(f->delay + f->taps) - 1;
+    MODCON = 0x8FF8; // X modulo on W8, no Y or bit reversed addressing
+    __asm__ volatile(
+        "nop\n\t" // MODCON takes effect one instruction after the write
+        "clr A, [%1]+=2, w4, [%2]-=2, w6\n\t"
+        "repeat %3\n\t"
+        "mac w4*w6, A, [%1]+=2, w4, [%2]-=2, w6\n\t"
+        "mac w4*w6, A\n\t"
+        "sac.r A, %0"
+        : "=r"(out), "+r"(xp), "+r"(yp)
+        : "r"(f->taps - 2)
+        : "w4", "w6", "A", "cc", "memory"); // reads the delay line stored above
+    MODCON = 0;
+    RESTORE_CPU_IPL(saved_ipl);
+    return out;
+#else
+    // the same walk, the pointer wrapped as the address generator does
+    const int16_t *h = &f->coeffs[f->taps - 1];
+    const int16_t *p = &f->delay[oldest];
+    const int16_t *end = f->delay + f->taps;
+    ACC_DECLARE;
+    ACC_CLR();
+    for (uint8_t k = 0; k < f->taps; k++) {
+        ACC_MAC(*h--, *p);
+        if (++p == end) {
+            p = f->delay;
+        }
+    }
+    return ACC_SACR(0);
+#endif
+}
+
+void dsp_biquad_init(dsp_biquad *s, const int16_t b[3], const int16_t a[2]) {
+    s->b0 = b[0];
+    s->b1 = b[1];
+    s->b2 = b[2];
+    s->a1 = a[0];
+    s->a2 = a[1];
+    s->x1 = s->x2 = s->y1 = s->y2 = 0;
+}
+
+int16_t dsp_biquad_q15(dsp_biquad *s, int16_t x) {
+    ACC_DECLARE;
+    ACC_MPY(s->b0, x);
+    ACC_MAC(s->b1, s->x1);
+    ACC_MAC(s->b2, s->x2);
+    ACC_MSC(s->a1, s->y1);
+    ACC_MSC(s->a2, s->y2);
+    int16_t y = ACC_SACR(-1); // Q14 coefficients, one bit back to Q15
+    s->x2 = s->x1;
+    s->x1 = x;
+    s->y2 = s->y1;
+    s->y1 = y;
+    return y;
+}
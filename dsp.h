@@ -0,0 +1,86 @@
+/*
+ * File:   dsp.h
+ * Author: EMBG2
+ * Comments: Q15 vector and filter kernels on the DSP engine.
+ *           On the target every multiply-accumulate is one MAC/MSC
+ *           instruction into accumulator A: fractional mode (a Q15 x Q15
+ *           product is Q31), 40-bit accumulator with 9.31 saturation,
+ *           conventional rounding and saturation when the result is
+ *           stored back to 16 bits. The host build emulates exactly that,
+ *           so both give the same bits for the same input.
+ *           Kernels are not reentrant on the target: they own
+ *           accumulator A, so call them from the main loop only.
+ * Revision history:
+ */
+
+#ifndef DSP_H
+#define	DSP_H
+
+#include <stdint.h>
+
+#define DSP_Q15_ONE 32767
+#define DSP_Q14_ONE 16384 // biquad coefficients, so that |a1| < 2 fits
+
+// storage for dsp_fir_mod_q15. The delay line is aligned to the power of
+// two at or above its size, as modulo addressing needs for an incrementing
+// buffer. The coefficients must be in Y data space, where the MAC
+// prefetches read them from. Both need static storage, stack arrays
+// are not aligned
+#define DSP_POW2(n) ((n) <= 2 ? 2 : (n) <= 4 ? 4 : (n) <= 8 ? 8 : (n) <= 16 ? 16 : (n) <= 32 ? 32 \
+                     : (n) <= 64 ? 64 : (n) <= 128 ? 128 : (n) <= 256 ? 256 : 512)
+#ifdef __XC16__
+#define DSP_DELAY_LINE(name, taps) int16_t name[taps] __attribute__((space(xmemory), aligned(DSP_POW2(2 * (taps)))))
+#define DSP_COEFFS(name, taps) int16_t name[taps] __attribute__((space(ymemory)))
+#else
+#define DSP_DELAY_LINE(name, taps) int16_t name[taps] __attribute__((aligned(DSP_POW2(2 * (taps)))))
+#define DSP_COEFFS(name, taps) int16_t name[taps]
+#endif
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+// FIR filter, at most 255 taps. delay holds taps samples, newest at index
+typedef struct {
+    const int16_t *coeffs; // Q15, h[0] applies to the newest sample
+    int16_t *delay;
+    uint8_t taps;
+    uint8_t index;
+} dsp_fir;
+
+// direct form I section, y = b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2, coefficients Q14
+typedef struct {
+    int16_t b0, b1, b2, a1, a2;
+    int16_t x1, x2, y1, y2;
+} dsp_biquad;
+
+// configures the DSP engine (CORCON), before any other dsp_ call
+void dsp_init(void);
+
+// out[i] = a[i] + b[i], saturated
+void dsp_add_q15(int16_t *out, const int16_t *a, const int16_t *b, uint16_t n);
+// out[i] = x[i] * k, rounded and saturated
+void dsp_scale_q15(int16_t *out, const int16_t *x, int16_t k, uint16_t n);
+// sum of a[i] * b[i], accumulated in 40 bits, then rounded and saturated to Q15
+int16_t dsp_dot_q15(const int16_t *a, const int16_t *b, uint16_t n);
+
+// clears the delay line
+void dsp_fir_init(dsp_fir *f, const int16_t *coeffs, int16_t *delay, uint8_t taps);
+// feeds one sample, returns the filter output
+int16_t dsp_fir_q15(dsp_fir *f, int16_t x);
+// same result, for a DSP_DELAY_LINE delay line and DSP_COEFFS coefficients
+// and at least 2 taps: one REPEATed MAC per tap, the delay line wrapped by
+// X modulo addressing instead of two loops. Uses W8 as the modulo register
+// with interrupts held off, and must not run while anything else uses
+// modulo addressing
+int16_t dsp_fir_mod_q15(dsp_fir *f, int16_t x);
+
+// b[] and a[] in Q14, a[0] is 1 and not stored
+void dsp_biquad_init(dsp_biquad *s, const int16_t b[3], const int16_t a[2]);
+int16_t dsp_biquad_q15(dsp_biquad *s, int16_t x);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* DSP_H */
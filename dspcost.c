@@ -0,0 +1,84 @@
+#include "xc.h"
+#include "dspcost.h"
+#include "dsp.h"
+#include "mag.h"
+#include <stdio.h>
+
+#define COST_TAPS 16
+#define COST_SAMPLES 16
+#define COST_RUNS 7
+
+static const int16_t cost_fir[COST_TAPS] = { // low-pass at a tenth of the sample rate
+    -114, -159, -139, 291, 1450, 3284, 5246, 6525,
+    6524, 5246, 3284, 1450, 291, -139, -159, -114
+};
+static DSP_DELAY_LINE(cost_delay, COST_TAPS);
+static DSP_COEFFS(cost_fir_y, COST_TAPS);
+static const int16_t cost_b[3] = {1106, 2210, 1106}; // Butterworth, same cutoff, Q14
+static const int16_t cost_a[2] = {-18727, 6763};
+static DSP_DELAY_LINE(cost_average_delay, MOVING_AVERAGE_SIZE); // the $MAG moving average
+static DSP_COEFFS(cost_average, MOVING_AVERAGE_SIZE);
+
+static int16_t fir_c(const int16_t *h, int16_t *delay, uint8_t *index, int16_t x) {
+    int i = *index;
+    int32_t sum = 1L << 14;
+    delay[i] = x;
+    for (int k = 0; k < COST_TAPS; k++) {
+        sum += (int32_t)h[k] * delay[i];
+        i = (i == 0) ? COST_TAPS - 1 : i - 1;
+    }
+    *index = (*index + 1 == COST_TAPS) ? 0 : *index + 1;
+    return (int16_t)(sum >> 15);
+}
+
+static int16_t biquad_c(dsp_biquad *s, int16_t x) {
+    int32_t sum = 1L << 13;
+    sum += (int32_t)s->b0 * x + (int32_t)s->b1 * s->x1 + (int32_t)s->b2 * s->x2;
+    sum -= (int32_t)s->a1 * s->y1 + (int32_t)s->a2 * s->y2;
+    int16_t y = (int16_t)(sum >> 14);
+    s->x2 = s->x1;
+    s->x1 = x;
+    s->y2 = s->y1;
+    s->y1 = y;
+    return y;
+}
+
+void dspcost_format(char *reply) {
+    int16_t delay[COST_TAPS];
+    volatile int16_t y; // keeps the filters from being optimised away
+    int16_t window[MOVING_AVERAGE_SIZE] = {0};
+    uint16_t cycles[COST_RUNS];
+    uint8_t index = 0, window_index = 0;
+    dsp_fir f, fm, avg;
+    dsp_biquad s;
+
+    for (int k = 0; k < COST_TAPS; k++) {
+        cost_fir_y[k] = cost_fir[k];
+    }
+    for (int k = 0; k < MOVING_AVERAGE_SIZE; k++) {
+        cost_average[k] = DSP_Q15_ONE / MOVING_AVERAGE_SIZE;
+    }
+    for (int run = 0; run < COST_RUNS; run++) {
+        dsp_fir_init(&f, cost_fir, delay, COST_TAPS);
+        dsp_fir_init(&fm, cost_fir_y, cost_delay, COST_TAPS);
+        dsp_fir_init(&avg, cost_average, cost_average_delay, MOVING_AVERAGE_SIZE);
+        dsp_biquad_init(&s, cost_b, cost_a);
+        uint16_t start = TMR3;
+        for (int n = 0; n < COST_SAMPLES; n++) {
+            int16_t x = (n & 4) ? 8000 : -8000; // square wave
+            switch (run) {
+                case 0: y = fir_c(cost_fir, delay, &index, x); break;
+                case 1: y = dsp_fir_q15(&f, x); break;
+                case 2: y = dsp_fir_mod_q15(&fm, x); break;
+                case 3: y = biquad_c(&s, x); break;
+                case 4: y = dsp_biquad_q15(&s, x); break;
+                case 5: y = calculate_moving_average(x, window, &window_index); break;
+                default: y = dsp_fir_mod_q15(&avg, x); break;
+            }
+        }
+        cycles[run] = (uint16_t)(TMR3 - start) / COST_SAMPLES;
+    }
+    (void)y;
+    sprintf(reply, "$DSP,COST,%u,%u,%u,%u,%u,%u,%u*\n",
+            cycles[0], cycles[1], cycles[2], cycles[3], cycles[4], cycles[5], cycles[6]);
+}
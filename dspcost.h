@@ -0,0 +1,30 @@
+/*
+ * File:   dspcost.h
+ * Author: EMBG2
+ * Comments: $DSP,COST, the DSP kernels timed against the same filters
+ *           written in plain C with 32-bit sums, so the two can be
+ *           compared on the target. Runs from the command handler in the
+ *           main loop; the interrupts it takes while timing count too, so
+ *           query it a few times and keep the lowest figures.
+ * Revision history:
+ */
+
+#ifndef DSPCOST_H
+#define	DSPCOST_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+// "$DSP,COST,fir_c,fir,fir_mod,biquad_c,biquad,avg_c,avg_mod*\n": Timer3
+// cycles per sample of a 16 tap FIR, of a biquad and of the $MAG moving
+// average, in C and with the dsp.h kernels. avg_c is the former
+// calculate_moving_average path, avg_mod the filter the main loop runs.
+// Needs Timer3 running (prof_init) and a reply of 64 bytes
+void dspcost_format(char *reply);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* DSPCOST_H */
@@ -0,0 +1,82 @@
+#include "xc.h"
+#include "event.h"
+#include "timer.h"
+#include "trace.h"
+#include "stats.h"
+#include "prof.h"
+
+static event_lane lanes[EVENT_LANE_COUNT];
+volatile unsigned int event_overflows = 0;
+
+void event_init(void) {
+    for (int i = 0; i < EVENT_LANE_COUNT; i++) {
+        lanes[i].head = 0;
+        lanes[i].tail = 0;
+    }
+    event_overflows = 0;
+}
+
+int event_post(int lane, uint8_t event) {
+    event_lane *l = &lanes[lane];
+    uint8_t head = l->head;
+    if ((uint8_t)(head - l->tail) == EVENT_LANE_SIZE) {
+        event_overflows++;
+        return 0;
+    }
+    l->events[head & (EVENT_LANE_SIZE - 1)] = event;
+    l->head = head + 1; // publish after the slot is written
+    return 1;
+}
+
+uint8_t event_get(void) {
+    for (int i = 0; i < EVENT_LANE_COUNT; i++) {
+        event_lane *l = &lanes[i];
+        uint8_t tail = l->tail;
+        if (tail != l->head) {
+            uint8_t event = l->events[tail & (EVENT_LANE_SIZE - 1)];
+            l->tail = tail + 1; // release the slot after it is read
+            return event;
+        }
+    }
+    return EVENT_NONE;
+}
+
+int event_pending(int lane) {
+    return lanes[lane].head != lanes[lane].tail;
+}
+
+void event_idle(void) {
+    // with the CPU priority at 7 an interrupt still wakes the core from Idle
+    // but is serviced only once the priority is restored, so an event posted
+    // between the check and Idle() cannot be missed
+    unsigned int ipl = SRbits.IPL;
+    SRbits.IPL = 7;
+    int empty = 1;
+    for (int i = 0; i < EVENT_LANE_COUNT; i++) {
+        if (event_pending(i)) {
+            empty = 0;
+        }
+    }
+    if (empty) {
+        Idle();
+    }
+    SRbits.IPL = ipl;
+}
+
+void event_tick_start(int ms) {
+    tmr_setup_period(TIMER2, ms);
+    IFS0bits.T2IF = 0;
+    IEC0bits.T2IE = 1;
+    tmr_turn(TIMER2, 1);
+}
+
+void __attribute__((__interrupt__, auto_psv)) _T2Interrupt(void) {
+    PROF_ISR_ENTER(T2);
+    uint16_t late = TMR2; // the counter restarted from zero when the flag was raised
+    PROF_ISR_LATENCY(T2, late < 1024 ? late * 64 : 0xFFFF);
+    IFS0bits.T2IF = 0;
+    stats.isr[STAT_ISR_T2]++;
+    trace_tick();
+    event_post(EVENT_LANE_TIMER2, EVENT_TICK);
+    PROF_ISR_EXIT(T2);
+}
@@ -0,0 +1,58 @@
+/* 
+ * File:   event.h
+ * Author: EMBG2
+ * Comments: event queue between the interrupts and the main loop. Every
+ *           producer (interrupt) owns one lane, a single producer /
+ *           single consumer ring, so posting never needs a lock or
+ *           masking interrupts. The main loop drains the lanes and
+ *           idles when they are empty.
+ * Revision history: 
+ */
+
+#ifndef EVENT_H
+#define	EVENT_H
+
+#include <stdint.h>
+
+#define EVENT_LANE_SIZE 8 // power of two
+
+// producers, one lane each
+#define EVENT_LANE_UART1_RX 0
+#define EVENT_LANE_UART2_RX 1
+#define EVENT_LANE_TIMER2 2
+#define EVENT_LANE_COUNT 3
+
+// event types
+#define EVENT_NONE 0
+#define EVENT_RX_FRAME_1 1 // a '*' closed a message on UART1
+#define EVENT_TICK 2       // the control period elapsed
+#define EVENT_RX_FRAME_2 3 // a '*' closed a message on UART2
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    volatile uint8_t head; // written by the producer only
+    volatile uint8_t tail; // written by the consumer only
+    uint8_t events[EVENT_LANE_SIZE];
+} event_lane;
+
+extern volatile unsigned int event_overflows;
+
+void event_init(void);
+// called only by the lane's producer, returns 0 when the lane is full
+int event_post(int lane, uint8_t event);
+// next event, lanes in index order, EVENT_NONE when all are empty
+uint8_t event_get(void);
+int event_pending(int lane);
+// sleeps until the next interrupt unless an event is already queued
+void event_idle(void);
+// starts Timer2 with its interrupt posting EVENT_TICK every ms
+void event_tick_start(int ms);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* EVENT_H */
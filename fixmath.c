@@ -0,0 +1,135 @@
+#include "fixmath.h"
+
+// sin over the first quadrant, 64 steps, Q15
+static const int16_t sin_table[65] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602,
+    6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+    12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+    18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+    23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+    27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+    32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+    32767
+};
+
+// (num << 15) / den for 0 <= num < den <= 32767, the result fits in 16 bits
+static int32_t div_q15(int32_t num, int32_t den) {
+#ifdef __XC16__
+    return __builtin_divsd(num << 15, (int16_t)den); // single 32/16 hardware divide
+#else
+    return (num << 15) / den;
+#endif
+}
+
+// atan(z) for z = 0..1 (Q15) as a binary angle
+static int32_t atan_octant(int32_t z) {
+    // atan(z) ~ pi/4 z + z (1 - z) (0.2447 + 0.0663 z), scaled to 32768 / pi
+    int32_t t = 2552 + ((692 * z) >> 15);
+    int32_t u = (z * (32768 - z)) >> 15;
+    return ((8192 * z) >> 15) + ((u * t) >> 15);
+}
+
+int16_t fx_atan2(int16_t y, int16_t x) {
+    int32_t ax = (x < 0) ? -(int32_t)x : x;
+    int32_t ay = (y < 0) ? -(int32_t)y : y;
+    int32_t angle;
+
+    if (ax == 0 && ay == 0) {
+        return 0;
+    }
+    if (ax > INT16_MAX || ay > INT16_MAX) {
+        ax >>= 1; // keeps the divisor in 16 bits
+        ay >>= 1;
+    }
+    if (ay == ax) {
+        angle = FX_ANGLE_90 / 2;
+    } else if (ay < ax) {
+        angle = atan_octant(div_q15(ay, ax));
+    } else {
+        angle = FX_ANGLE_90 - atan_octant(div_q15(ax, ay));
+    }
+    if (x < 0) {
+        angle = FX_ANGLE_180 - angle;
+    }
+    if (y < 0) {
+        angle = -angle;
+    }
+    return (int16_t)angle;
+}
+
+int16_t fx_sin(int16_t angle) {
+    uint16_t a = (uint16_t)angle;
+    uint16_t p = a & 0x3FFF;
+    int16_t value;
+
+    if (a & 0x4000) {
+        p = 0x4000 - p; // second and fourth quadrant mirror the first
+    }
+    uint16_t i = p >> 8;
+    if (i == 64) {
+        value = sin_table[64];
+    } else {
+        int16_t frac = p & 0xFF;
+        value = sin_table[i] + (int16_t)(((int32_t)(sin_table[i + 1] - sin_table[i]) * frac) >> 8);
+    }
+    return (a & 0x8000) ? -value : value;
+}
+
+int16_t fx_cos(int16_t angle) {
+    return fx_sin((int16_t)(angle + FX_ANGLE_90));
+}
+
+uint16_t fx_sqrt(uint32_t value) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint16_t)root;
+}
+
+int16_t fx_angle_to_deg(int16_t angle) {
+    return (int16_t)(((int32_t)angle * 180) / 32768); // toward zero, a shift would floor
+}
+
+int fx_normalize3(const int16_t v[3], int16_t out[3]) {
+    // up to 3 * 2^30, past INT32_MAX
+    uint32_t squares = (uint32_t)((int32_t)v[0] * v[0]) + (uint32_t)((int32_t)v[1] * v[1])
+                       + (uint32_t)((int32_t)v[2] * v[2]);
+    int32_t norm = fx_sqrt(squares);
+    int shift = 0;
+
+    if (norm == 0) {
+        return 0;
+    }
+    while ((norm >> shift) > INT16_MAX) {
+        shift++; // keeps the divisor in 16 bits
+    }
+    norm >>= shift;
+    for (int i = 0; i < 3; i++) {
+        int32_t c = v[i] >> shift;
+        int32_t a = (c < 0) ? -c : c;
+        int32_t q = (a >= norm) ? INT16_MAX : div_q15(a, norm);
+        out[i] = (int16_t)((c < 0) ? -q : q);
+    }
+    return 1;
+}
+
+int16_t fx_mul_q15(int16_t a, int16_t b) {
+    int32_t product = ((int32_t)a * b + (1L << 14)) >> 15;
+    if (product > INT16_MAX) {
+        product = INT16_MAX;
+    }
+    return (int16_t)product;
+}
@@ -0,0 +1,38 @@
+/* 
+ * File:   fixmath.h
+ * Author: EMBG2
+ * Comments: integer trigonometry for the heading path.
+ *           Angles are 16 bit binary angles: 32768 = 180 degrees, so
+ *           wrap-around is free. sin/cos results are Q15.
+ * Revision history: 
+ */
+
+#ifndef FIXMATH_H
+#define	FIXMATH_H
+
+#include <stdint.h>
+
+#define FX_ANGLE_90 16384
+#define FX_ANGLE_180 ((int32_t)32768)
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+// atan2(y, x) as a binary angle, max error about 0.1 degrees
+int16_t fx_atan2(int16_t y, int16_t x);
+int16_t fx_sin(int16_t angle);
+int16_t fx_cos(int16_t angle);
+uint16_t fx_sqrt(uint32_t value);
+// binary angle to whole degrees in [-180, 180), truncated toward zero
+int16_t fx_angle_to_deg(int16_t angle);
+// Q15 product with rounding
+int16_t fx_mul_q15(int16_t a, int16_t b);
+// scales v to a Q15 unit vector, returns 0 (and leaves out alone) for a null vector
+int fx_normalize3(const int16_t v[3], int16_t out[3]);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* FIXMATH_H */
@@ -0,0 +1,37 @@
+#include "heading.h"
+#include "fixmath.h"
+
+uint32_t heading_cycles_last = 0;
+uint32_t heading_cycles_max = 0;
+
+// brings a pair of 32 bit components back into int16 range, keeping their ratio
+static void fit_int16(int32_t *a, int32_t *b) {
+    while (*a > INT16_MAX || *a < -INT16_MAX || *b > INT16_MAX || *b < -INT16_MAX) {
+        *a /= 2;
+        *b /= 2;
+    }
+}
+
+void tilt_angles(const int16_t acc[3], int16_t *roll, int16_t *pitch) {
+    *roll = fx_atan2(acc[1], acc[2]);
+    int32_t acc_yz = ((int32_t)acc[1] * fx_sin(*roll) + (int32_t)acc[2] * fx_cos(*roll)) >> 15;
+    int32_t minus_ax = -(int32_t)acc[0];
+    fit_int16(&minus_ax, &acc_yz);
+    *pitch = fx_atan2((int16_t)minus_ax, (int16_t)acc_yz);
+}
+
+int16_t tilt_heading(const int16_t mag[3], const int16_t acc[3]) {
+    int16_t roll, pitch;
+    tilt_angles(acc, &roll, &pitch);
+    int16_t sin_roll = fx_sin(roll);
+    int16_t cos_roll = fx_cos(roll);
+    int16_t sin_pitch = fx_sin(pitch);
+    int16_t cos_pitch = fx_cos(pitch);
+
+    // rotate the magnetic vector by -roll around x, then by -pitch around y
+    int32_t mag_yz = ((int32_t)mag[1] * sin_roll + (int32_t)mag[2] * cos_roll) >> 15;
+    int32_t by = ((int32_t)mag[1] * cos_roll - (int32_t)mag[2] * sin_roll) >> 15;
+    int32_t bx = ((int32_t)mag[0] * cos_pitch + mag_yz * sin_pitch) >> 15;
+    fit_int16(&by, &bx);
+    return fx_atan2((int16_t)by, (int16_t)bx);
+}
@@ -0,0 +1,36 @@
+/* 
+ * File:   heading.h
+ * Author: EMBG2
+ * Comments: tilt compensated heading, integer only.
+ *           Roll and pitch come from the accelerometer, the magnetic
+ *           vector is rotated back to the horizontal plane and the
+ *           heading is atan2 of its horizontal components. With the board
+ *           level it reduces to atan2(my, mx) like the old $YAW.
+ *           The accelerometer and magnetometer axes are assumed aligned,
+ *           as they are inside the BMX055.
+ * Revision history: 
+ */
+
+#ifndef HEADING_H
+#define	HEADING_H
+
+#include <stdint.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+// returns the heading as a binary angle (see fixmath.h)
+int16_t tilt_heading(const int16_t mag[3], const int16_t acc[3]);
+// roll and pitch of the board from the gravity vector, binary angles
+void tilt_angles(const int16_t acc[3], int16_t *roll, int16_t *pitch);
+
+// cost of tilt_heading() in instruction cycles, measured by the main loop
+extern uint32_t heading_cycles_last;
+extern uint32_t heading_cycles_max;
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* HEADING_H */
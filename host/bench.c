@@ -0,0 +1,478 @@
+/*
+ * File:   bench.c
+ * Author: EMBG2
+ *
+ * Host micro-benchmarks for the firmware hot paths (buffer, parser,
+ * magnetometer conditioning and $MAG formatting). The *_c filter entries
+ * are the plain C versions of the dsp.c kernels next to them, for
+ * comparison; on the host the kernels run the DSP engine emulation.
+ * Results are printed as CSV on stdout, one line per benchmark:
+ *   name,calls,best_ns_per_call,mean_ns_per_call,mcalls_per_s
+ *
+ * Build and run from the repository root:
+ *   gcc -std=gnu99 -O2 -Ihost -I. host/bench.c host/xc.c buffer.c parser.c mag.c calib.c dsp.c fixmath.c heading.c ahrs.c magacq.c spi.c magz.c -o bench -lm
+ *   ./bench [iterations] > bench_output.txt
+ *   ./bench tilt     heading error of tilt_heading over a roll / pitch sweep
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "buffer.h"
+#include "parser.h"
+#include "mag.h"
+#include "calib.h"
+#include "fixmath.h"
+#include "heading.h"
+#include "ahrs.h"
+#include "magacq.h"
+#include "magz.h"
+#include "dsp.h"
+
+#define BENCH_REPEATS 5
+#define BENCH_FIR_TAPS 16
+
+typedef void (*bench_fn)(long iters);
+
+static volatile long sink; // keeps the compiler from discarding results
+
+// realistic command traffic: valid commands, echo-sized payloads and line noise
+static const char command_stream[] =
+    "$RATE,5*$RATE,10*noise$RATE,0*$RATE,3*\r\n"
+    "$RATE,1*xx$RATE,2*$ABCDEFG,1*$RATE,4*"
+    "$MSG,hello,world,1,2,3*$RATE,*$RATE,5*";
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench_buffer_write_read(long iters) {
+    char c;
+    long acc = 0;
+    buffer_init(&main_buffer_1);
+    for (long i = 0; i < iters; i++) {
+        buffer_write(&main_buffer_1, (char)i);
+        buffer_read(&main_buffer_1, &c);
+        acc += c;
+    }
+    sink = acc;
+}
+
+static void bench_buffer_fill_drain(long iters) {
+    char c;
+    long acc = 0;
+    buffer_init(&main_buffer_1);
+    for (long i = 0; i < iters; i += main_buffer_1.size) {
+        for (int k = 0; k < main_buffer_1.size; k++) {
+            buffer_write(&main_buffer_1, (char)k);
+        }
+        while (buffer_read(&main_buffer_1, &c)) {
+            acc += c;
+        }
+    }
+    sink = acc;
+}
+
+static char *bench_patterns[] = {"$RATE,", "$MSG,", "*"};
+
+static void bench_detect_pattern(long iters) {
+    PatternDetector detector;
+    long acc = 0;
+    const int len = sizeof(command_stream) - 1;
+    buffer_init(&main_buffer_1);
+    pattern_detector_init(&detector, &main_buffer_1, bench_patterns, 3);
+    for (long i = 0; i < iters; i++) {
+        buffer_write(&main_buffer_1, command_stream[i % len]);
+        if (main_buffer_1.count == 8) {
+            detect_pattern(&detector);
+            acc += detector.flags[0];
+        }
+    }
+    sink = acc;
+}
+
+static void bench_parse_byte(long iters) {
+    parser_state ps = { .state = STATE_DOLLAR };
+    long acc = 0;
+    const int len = sizeof(command_stream) - 1;
+    for (long i = 0, j = 0; i < iters; i++) {
+        acc += parse_byte(&ps, command_stream[j]);
+        if (++j == len) {
+            j = 0;
+        }
+    }
+    sink = acc;
+}
+
+// the RX path per received byte: the ring filled as the interrupt does,
+// then drained byte by byte or in spans as process_uart does
+static void fill_rx_ring(long *j) {
+    const int len = sizeof(command_stream) - 1;
+    while (buffer_write(&main_buffer_1, command_stream[*j])) {
+        if (++*j == len) {
+            *j = 0;
+        }
+    }
+}
+
+static void bench_ring_parse_byte(long iters) {
+    parser_state ps = { .state = STATE_DOLLAR };
+    long acc = 0, j = 0;
+    char c;
+    buffer_init(&main_buffer_1);
+    for (long i = 0; i < iters; i += main_buffer_1.size) {
+        fill_rx_ring(&j);
+        while (buffer_read(&main_buffer_1, &c)) {
+            acc += parse_byte(&ps, c);
+        }
+    }
+    sink = acc;
+}
+
+static void bench_ring_parse_bytes(long iters) {
+    parser_state ps = { .state = STATE_DOLLAR };
+    long acc = 0, j = 0;
+    char *span;
+    int len, used;
+    buffer_init(&main_buffer_1);
+    for (long i = 0; i < iters; i += main_buffer_1.size) {
+        fill_rx_ring(&j);
+        while ((len = buffer_span(&main_buffer_1, &span)) > 0) {
+            acc += parse_bytes(&ps, span, len, &used);
+            buffer_consume(&main_buffer_1, used);
+        }
+    }
+    sink = acc;
+}
+
+static void bench_extract_integer(long iters) {
+    static const char *values[] = {"5", "10", "-123", "+42,7", "32767"};
+    long acc = 0;
+    for (long i = 0; i < iters; i++) {
+        acc += extract_integer(values[i % 5]);
+    }
+    sink = acc;
+}
+
+static void bench_moving_average(long iters) {
+    int16_t window[MOVING_AVERAGE_SIZE] = {0};
+    uint8_t idx = 0;
+    long acc = 0;
+    for (long i = 0; i < iters; i++) {
+        acc += calculate_moving_average((int16_t)(i & 0x3FF) - 512, window, &idx);
+    }
+    sink = acc;
+}
+
+static void bench_merge_significant_bits(long iters) {
+    long acc = 0;
+    for (long i = 0; i < iters; i++) {
+        acc += merge_significant_bits((uint8_t)i, (uint8_t)(i >> 8), 1 + (int)(i % 3));
+    }
+    sink = acc;
+}
+
+static void bench_mag_format(long iters) {
+    char line[35];
+    long acc = 0;
+    for (long i = 0; i < iters; i++) {
+        acc += mag_format(line, (int16_t)(i & 0xFFF) - 2048, -(int16_t)(i & 0x7FF), 1234);
+    }
+    sink = acc;
+}
+
+static void bench_calib_apply(long iters) {
+    mag_calibration cal = {{120, -85, 40}, {{31000, 410, -120}, {410, 32767, 95}, {-120, 95, 30500}}};
+    int16_t raw[3], out[3];
+    long acc = 0;
+    for (long i = 0; i < iters; i++) {
+        raw[0] = (int16_t)(i & 0x7FF) - 1024;
+        raw[1] = 512 - (int16_t)(i & 0x3FF);
+        raw[2] = (int16_t)(i & 0xFF);
+        calib_apply(&cal, raw, out);
+        acc += out[0] + out[1] + out[2];
+    }
+    sink = acc;
+}
+
+static void bench_fx_atan2(long iters) {
+    long acc = 0;
+    for (long i = 0; i < iters; i++) {
+        acc += fx_atan2((int16_t)(i * 7), (int16_t)(2000 - (i & 0xFFF)));
+    }
+    sink = acc;
+}
+
+static void bench_tilt_heading(long iters) {
+    int16_t mag[3] = {300, -120, 410};
+    int16_t acc3[3] = {-180, 240, 990};
+    long acc = 0;
+    for (long i = 0; i < iters; i++) {
+        mag[0] = 300 + (int16_t)(i & 0x3F);
+        acc3[0] = -180 + (int16_t)(i & 0x1F);
+        acc += tilt_heading(mag, acc3);
+    }
+    sink = acc;
+}
+
+static void bench_ahrs_update(long iters) {
+    int16_t gyro[3] = {120, -45, 300};
+    int16_t acc3[3] = {-180, 240, 990};
+    int16_t mag[3] = {300, -120, 410};
+    int16_t roll, pitch, yaw;
+    ahrs_init(10, acc3, mag);
+    for (long i = 0; i < iters; i++) {
+        gyro[0] = 120 + (int16_t)(i & 0x3F);
+        ahrs_update(gyro, acc3, mag);
+    }
+    ahrs_euler(&roll, &pitch, &yaw);
+    sink = roll + pitch + yaw;
+}
+
+// one magacq_push() per call with the given acquisition mode
+static void bench_magacq(int mode, long iters) {
+    int16_t in[3] = {300, -120, 410};
+    int16_t out[3];
+    long acc = 0;
+    magacq_set_mode(mode);
+    for (long i = 0; i < iters; i++) {
+        in[0] = 300 + (int16_t)(i & 0x1F);
+        if (magacq_push(in, out)) {
+            acc += out[0];
+        }
+    }
+    sink = acc;
+}
+
+static void bench_magacq_r1(long iters) { bench_magacq(0, iters); }
+static void bench_magacq_r2(long iters) { bench_magacq(1, iters); }
+static void bench_magacq_r4(long iters) { bench_magacq(2, iters); }
+static void bench_magacq_r8(long iters) { bench_magacq(3, iters); }
+
+// one magz_push() per call, a $MZ line is formatted every ten or so samples
+static void bench_magz_push(long iters) {
+    magz_encoder e;
+    char line[MAGZ_LINE_MAX];
+    int16_t v[3] = {300, -120, 410};
+    long acc = 0;
+    magz_init(&e);
+    for (long i = 0; i < iters; i++) {
+        v[0] = 300 + (int16_t)(i & 0x07);
+        v[1] = -120 - (int16_t)(i & 0x03);
+        acc += magz_push(&e, v, line);
+    }
+    sink = acc;
+}
+
+// 16 tap Hamming windowed low-pass at a tenth of the sample rate, Q15, sums to one
+static const int16_t fir_coeffs[BENCH_FIR_TAPS] = {
+    -114, -159, -139, 291, 1450, 3284, 5246, 6525,
+    6524, 5246, 3284, 1450, 291, -139, -159, -114
+};
+
+static int16_t bench_input(long i) {
+    return (int16_t)((i * 2654435761u) >> 20) - 2048;
+}
+
+// the same filter in plain C: 32-bit sum, modulo index
+static void bench_fir_c(long iters) {
+    int16_t delay[BENCH_FIR_TAPS] = {0};
+    uint8_t idx = 0;
+    long acc = 0;
+    for (long i = 0; i < iters; i++) {
+        delay[idx] = bench_input(i);
+        int32_t sum = 1L << 14;
+        for (int k = 0; k < BENCH_FIR_TAPS; k++) {
+            sum += (int32_t)fir_coeffs[k] * delay[(idx + BENCH_FIR_TAPS - k) % BENCH_FIR_TAPS];
+        }
+        idx = (idx + 1) % BENCH_FIR_TAPS;
+        acc += (int16_t)(sum >> 15);
+    }
+    sink = acc;
+}
+
+static void bench_dsp_fir(long iters) {
+    int16_t delay[BENCH_FIR_TAPS];
+    dsp_fir f;
+    long acc = 0;
+    dsp_fir_init(&f, fir_coeffs, delay, BENCH_FIR_TAPS);
+    for (long i = 0; i < iters; i++) {
+        acc += dsp_fir_q15(&f, bench_input(i));
+    }
+    sink = acc;
+}
+
+// 2nd order low-pass at a tenth of the sample rate
+static const double biquad_b[3] = {0.0675, 0.1349, 0.0675};
+static const double biquad_a[2] = {-1.1430, 0.4128};
+
+static void bench_biquad_c(long iters) {
+    double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+    long acc = 0;
+    for (long i = 0; i < iters; i++) {
+        double x = bench_input(i);
+        double y = biquad_b[0] * x + biquad_b[1] * x1 + biquad_b[2] * x2 - biquad_a[0] * y1 - biquad_a[1] * y2;
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = y;
+        acc += (long)y;
+    }
+    sink = acc;
+}
+
+static void bench_dsp_biquad(long iters) {
+    int16_t b[3], a[2];
+    dsp_biquad s;
+    long acc = 0;
+    for (int k = 0; k < 3; k++) {
+        b[k] = (int16_t)(biquad_b[k] * DSP_Q14_ONE + 0.5);
+    }
+    for (int k = 0; k < 2; k++) {
+        a[k] = (int16_t)(biquad_a[k] * DSP_Q14_ONE + (biquad_a[k] < 0 ? -0.5 : 0.5));
+    }
+    dsp_biquad_init(&s, b, a);
+    for (long i = 0; i < iters; i++) {
+        acc += dsp_biquad_q15(&s, bench_input(i));
+    }
+    sink = acc;
+}
+
+static DSP_DELAY_LINE(bench_delay, BENCH_FIR_TAPS);
+
+static void bench_dsp_fir_mod(long iters) {
+    dsp_fir f;
+    long acc = 0;
+    dsp_fir_init(&f, fir_coeffs, bench_delay, BENCH_FIR_TAPS);
+    for (long i = 0; i < iters; i++) {
+        acc += dsp_fir_mod_q15(&f, bench_input(i));
+    }
+    sink = acc;
+}
+
+static void bench_dsp_dot(long iters) {
+    int16_t x[BENCH_FIR_TAPS];
+    long acc = 0;
+    for (int k = 0; k < BENCH_FIR_TAPS; k++) {
+        x[k] = bench_input(k);
+    }
+    for (long i = 0; i < iters; i++) {
+        x[i & (BENCH_FIR_TAPS - 1)] = bench_input(i);
+        acc += dsp_dot_q15(fir_coeffs, x, BENCH_FIR_TAPS);
+    }
+    sink = acc;
+}
+
+static const struct {
+    const char *name;
+    bench_fn fn;
+    long scale; // divides the iteration count for the slow paths
+} benches[] = {
+    {"buffer_write_read", bench_buffer_write_read, 1},
+    {"buffer_fill_drain", bench_buffer_fill_drain, 1},
+    {"detect_pattern", bench_detect_pattern, 4},
+    {"parse_byte", bench_parse_byte, 1},
+    {"ring_parse_byte", bench_ring_parse_byte, 1},
+    {"ring_parse_bytes", bench_ring_parse_bytes, 1},
+    {"extract_integer", bench_extract_integer, 1},
+    {"calculate_moving_average", bench_moving_average, 1},
+    {"merge_significant_bits", bench_merge_significant_bits, 1},
+    {"calib_apply", bench_calib_apply, 1},
+    {"fx_atan2", bench_fx_atan2, 1},
+    {"tilt_heading", bench_tilt_heading, 1},
+    {"ahrs_update", bench_ahrs_update, 1},
+    {"magacq_push_r1", bench_magacq_r1, 1},
+    {"magacq_push_r2", bench_magacq_r2, 1},
+    {"magacq_push_r4", bench_magacq_r4, 1},
+    {"magacq_push_r8", bench_magacq_r8, 1},
+    {"magz_push", bench_magz_push, 1},
+    {"fir16_c", bench_fir_c, 1},
+    {"dsp_fir16", bench_dsp_fir, 1},
+    {"dsp_fir16_mod", bench_dsp_fir_mod, 1},
+    {"dsp_dot16", bench_dsp_dot, 1},
+    {"biquad_c", bench_biquad_c, 1},
+    {"dsp_biquad", bench_dsp_biquad, 1},
+    {"mag_format", bench_mag_format, 10},
+};
+
+// tilt sweep: the board rolled and pitched by up to tilt degrees at every
+// heading, the sensors read through a rotation of gravity and of a field
+// with the inclination of central Europe, at the magnitudes the BMX055
+// gives (1 g = 1024 LSB, 300 LSB horizontal field). Error of tilt_heading
+// against the true heading, in degrees
+#define TILT_PI 3.14159265358979323846
+
+static void tilt_rotate(double v[3], double roll, double pitch) {
+    double x = v[0], y = v[1], z = v[2];
+    // pitch around y, then roll around x
+    v[0] = x * cos(pitch) + z * sin(pitch);
+    z = -x * sin(pitch) + z * cos(pitch);
+    v[1] = y * cos(roll) - z * sin(roll);
+    v[2] = y * sin(roll) + z * cos(roll);
+}
+
+static void tilt_sweep(void) {
+    printf("tilt_deg,max_error_deg,rms_error_deg\n");
+    for (int tilt = 10; tilt <= 60; tilt += 10) {
+        double max = 0, sum = 0;
+        long n = 0;
+        for (int r = -tilt; r <= tilt; r += 2) {
+            for (int p = -tilt; p <= tilt; p += 2) {
+                for (int h = 0; h < 360; h += 3) {
+                    double roll = r * TILT_PI / 180, pitch = p * TILT_PI / 180, hdg = h * TILT_PI / 180;
+                    double g[3] = {0, 0, 1024};
+                    double b[3] = {300 * cos(hdg), 300 * sin(hdg), -400};
+                    tilt_rotate(g, roll, pitch);
+                    tilt_rotate(b, roll, pitch);
+                    int16_t acc[3], mag[3];
+                    for (int i = 0; i < 3; i++) {
+                        acc[i] = (int16_t)lround(g[i]);
+                        mag[i] = (int16_t)lround(b[i]);
+                    }
+                    double err = tilt_heading(mag, acc) * 180.0 / 32768 - h;
+                    err = fmod(err + 540, 360) - 180;
+                    max = fabs(err) > max ? fabs(err) : max;
+                    sum += err * err;
+                    n++;
+                }
+            }
+        }
+        printf("%d,%.3f,%.3f\n", tilt, max, sqrt(sum / n));
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "tilt") == 0) {
+        tilt_sweep();
+        return 0;
+    }
+    long iters = (argc > 1) ? atol(argv[1]) : 10000000L;
+    if (iters <= 0) {
+        fprintf(stderr, "usage: %s [iterations] | tilt\n", argv[0]);
+        return 1;
+    }
+    SPI1STATbits.SPIRBF = 1; // the shim never clears it, so magacq's register writes return at once
+    printf("name,calls,best_ns_per_call,mean_ns_per_call,mcalls_per_s\n");
+    for (size_t b = 0; b < sizeof(benches) / sizeof(benches[0]); b++) {
+        long n = iters / benches[b].scale;
+        double best = 0, total = 0;
+        benches[b].fn(n / 10); // warm up caches and branch predictors
+        for (int r = 0; r < BENCH_REPEATS; r++) {
+            double t0 = now_ns();
+            benches[b].fn(n);
+            double dt = now_ns() - t0;
+            total += dt;
+            if (r == 0 || dt < best) {
+                best = dt;
+            }
+        }
+        printf("%s,%ld,%.3f,%.3f,%.3f\n", benches[b].name, n,
+               best / n, total / (BENCH_REPEATS * (double)n), n / best * 1e3);
+    }
+    return 0;
+}
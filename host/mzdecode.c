@@ -0,0 +1,261 @@
+/*
+ * File:   mzdecode.c
+ * Author: EMBG2
+ *
+ * Decoder for the compressed magnetometer stream ($MZ lines, see magz.h).
+ * Reads a recorded UART log, decodes every $MZ line and prints the
+ * samples as CSV on stdout. Other lines are ignored, so a raw capture of
+ * the port can be fed in directly. Batches that follow a lost line are
+ * skipped until the next keyframe.
+ *
+ * With -e the input is a log of $MAG lines instead: every sample is
+ * compressed with the firmware encoder (magz.c), decoded again and
+ * checked against the original, which measures the compression ratio on
+ * recorded data without the board.
+ *
+ * Build and run from the repository root:
+ *   gcc -std=gnu99 -O2 -Ihost -I. host/mzdecode.c magz.c mag.c -o mzdecode
+ *   ./mzdecode [-e] [log.txt] > samples.csv
+ *
+ * The summary goes to stderr:
+ *   lines,samples,lost_lines,skipped_batches,mz_bytes,mag_bytes,ratio,bytes_per_sample,decode_msamples_per_s
+ * mag_bytes is the size of the same samples sent as "$MAG,x,y,z*\n" lines.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "magz.h"
+#include "mag.h"
+
+typedef struct {
+    int16_t last[3];
+    int synced;       // last[] holds the last sample of the previous line
+    int next_seq;     // expected seq, -1 before the first line
+    long lines;
+    long samples;
+    long lost_lines;
+    long skipped;
+    long mz_bytes;
+    long mag_bytes;
+    int verify;       // -e: compare with the samples pushed into the encoder
+    int16_t *expected;
+    long expected_count;
+    long mismatches;
+} mz_decoder;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int base64_value(char c) {
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    if (c == '+') {
+        return 62;
+    }
+    if (c == '/') {
+        return 63;
+    }
+    return -1;
+}
+
+// decodes base64 up to the '*', returns the byte count or -1
+static int base64_decode(const char *s, uint8_t *out, int max) {
+    int n = 0, bits = 0;
+    uint32_t acc = 0;
+    for (; *s != '*'; s++) {
+        if (*s == '=') {
+            continue;
+        }
+        int v = base64_value(*s);
+        if (v < 0) {
+            return -1;
+        }
+        acc = (acc << 6) | (uint32_t)v;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            if (n == max) {
+                return -1;
+            }
+            out[n++] = (uint8_t)(acc >> bits);
+        }
+    }
+    return n;
+}
+
+static int get_varint(const uint8_t *p, int len, int *pos, uint16_t *v) {
+    uint32_t r = 0;
+    for (int shift = 0; *pos < len && shift < 21; shift += 7) {
+        uint8_t b = p[(*pos)++];
+        r |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = (uint16_t)r;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int16_t unzigzag(uint16_t v) {
+    return (int16_t)((v >> 1) ^ (uint16_t)-(int16_t)(v & 1));
+}
+
+static void emit(mz_decoder *d, const int16_t v[3]) {
+    char line[32];
+    if (d->verify) {
+        if (d->samples >= d->expected_count || memcmp(&d->expected[d->samples * 3], v, sizeof(int16_t) * 3) != 0) {
+            d->mismatches++;
+        }
+    } else {
+        printf("%d,%d,%d\n", v[0], v[1], v[2]);
+    }
+    d->mag_bytes += mag_format(line, v[0], v[1], v[2]);
+    d->samples++;
+}
+
+// one "$MZ,..." line, returns 0 if it is malformed
+static int decode_line(mz_decoder *d, const char *line) {
+    unsigned int seq, keyframe, count;
+    int start;
+    uint8_t payload[MAGZ_PAYLOAD_MAX];
+
+    if (sscanf(line, "$MZ,%u,%u,%u,%n", &seq, &keyframe, &count, &start) != 3 || strchr(line, '*') == NULL) {
+        return 0;
+    }
+    int len = base64_decode(line + start, payload, sizeof(payload));
+    if (len < 0) {
+        return 0;
+    }
+    d->lines++;
+    d->mz_bytes += (long)strlen(line);
+    if (d->next_seq >= 0 && (int)seq != d->next_seq) {
+        d->lost_lines += (seq - d->next_seq) & 0xFF;
+        d->synced = 0;
+    }
+    d->next_seq = (seq + 1) & 0xFF;
+    if (!keyframe && !d->synced) {
+        d->skipped++;
+        return 1;
+    }
+
+    int pos = 0;
+    for (unsigned int s = 0; s < count; s++) {
+        int16_t v[3];
+        for (int i = 0; i < 3; i++) {
+            uint16_t z;
+            if (!get_varint(payload, len, &pos, &z)) {
+                d->synced = 0;
+                return 0;
+            }
+            v[i] = (s == 0 && keyframe) ? unzigzag(z) : (int16_t)(d->last[i] + unzigzag(z));
+            d->last[i] = v[i];
+        }
+        emit(d, v);
+    }
+    d->synced = 1;
+    return pos == len;
+}
+
+static void decode_text(mz_decoder *d, const char *line) {
+    const char *mz = strstr(line, "$MZ,");
+    if (mz != NULL && !decode_line(d, mz)) {
+        fprintf(stderr, "bad line: %s", mz);
+    }
+}
+
+int main(int argc, char **argv) {
+    int encode = 0;
+    int arg = 1;
+    if (arg < argc && strcmp(argv[arg], "-e") == 0) {
+        encode = 1;
+        arg++;
+    }
+    FILE *f = arg < argc ? fopen(argv[arg], "r") : stdin;
+    if (f == NULL || arg + 1 < argc) {
+        fprintf(stderr, "usage: %s [-e] [log.txt]\n", argv[0]);
+        return 1;
+    }
+
+    mz_decoder d;
+    memset(&d, 0, sizeof(d));
+    d.next_seq = -1;
+    d.verify = encode;
+
+    char line[256];
+    char **lines = NULL;
+    long count = 0, cap = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (count == cap) {
+            cap = cap ? cap * 2 : 1024;
+            lines = realloc(lines, cap * sizeof(*lines));
+        }
+        lines[count++] = strdup(line);
+    }
+    if (f != stdin) {
+        fclose(f);
+    }
+
+    if (encode) {
+        // compress the $MAG samples first, the timing below covers decoding only
+        magz_encoder e;
+        char mz[MAGZ_LINE_MAX];
+        long n = 0;
+        d.expected = malloc(count * 3 * sizeof(int16_t) + 1);
+        magz_init(&e);
+        for (long i = 0; i < count; i++) {
+            int x, y, z;
+            const char *mag = strstr(lines[i], "$MAG,");
+            int ok = mag != NULL && sscanf(mag, "$MAG,%d,%d,%d", &x, &y, &z) == 3;
+            free(lines[i]);
+            lines[i] = NULL;
+            if (!ok) {
+                continue;
+            }
+            int16_t v[3] = {(int16_t)x, (int16_t)y, (int16_t)z};
+            memcpy(&d.expected[d.expected_count++ * 3], v, sizeof(v));
+            if (magz_push(&e, v, mz) > 0) {
+                lines[n++] = strdup(mz);
+            }
+        }
+        if (magz_flush(&e, mz) > 0) {
+            lines[n++] = strdup(mz);
+        }
+        count = n;
+    }
+
+    double start = now_s();
+    for (long i = 0; i < count; i++) {
+        decode_text(&d, lines[i]);
+    }
+    double wall = now_s() - start;
+
+    if (encode && (d.mismatches != 0 || d.samples != d.expected_count)) {
+        fprintf(stderr, "round trip failed: %ld of %ld samples differ, %ld decoded\n",
+                d.mismatches, d.expected_count, d.samples);
+    }
+    fprintf(stderr, "lines,samples,lost_lines,skipped_batches,mz_bytes,mag_bytes,ratio,bytes_per_sample,decode_msamples_per_s\n");
+    fprintf(stderr, "%ld,%ld,%ld,%ld,%ld,%ld,%.2f,%.2f,%.2f\n", d.lines, d.samples, d.lost_lines, d.skipped,
+            d.mz_bytes, d.mag_bytes, d.mz_bytes ? (double)d.mag_bytes / d.mz_bytes : 0.0,
+            d.samples ? (double)d.mz_bytes / d.samples : 0.0, wall > 0 ? d.samples / wall * 1e-6 : 0.0);
+
+    for (long i = 0; i < count; i++) {
+        free(lines[i]);
+    }
+    free(lines);
+    free(d.expected);
+    return encode && d.mismatches != 0;
+}
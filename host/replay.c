@@ -0,0 +1,165 @@
+/*
+ * File:   replay.c
+ * Author: EMBG2
+ *
+ * Replays a UART1 RX trace (as produced by $TRACE,DUMP*) through the
+ * firmware receive path: main_buffer_1, parse_bytes and process_uart.
+ * Bytes are written into the RX buffer at their recorded time.
+ * process_uart runs as soon as a '*' closes a frame and once per main
+ * loop period, like the event loop in newmainXC16.c does.
+ *
+ * Trace format, one byte per line, '#' lines are ignored:
+ *   <t_us> <hex byte>
+ *
+ * Build and run from the repository root:
+ *   gcc -std=gnu99 -O2 -Ihost -I. host/replay.c host/xc.c buffer.c parser.c mag.c uart.c command.c trace.c txq.c event.c timer.c calib.c dsp.c dspcost.c ahrs.c heading.c fixmath.c magacq.c spi.c timesync.c clock.c capture.c stats.c prof.c route.c magz.c rategen.c shed.c -o replay -lm
+ *   ./replay [-r] [-p period_us] trace.txt
+ *     -r  pace the bytes in real time instead of replaying at maximum speed
+ *     -p  main loop period in microseconds (default 10000)
+ *
+ * Prints one CSV header and one result line:
+ *   bytes,messages,errors,dropped_bytes,parser_resets,tx_dropped,trace_s,wall_s,msgs_per_s
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "buffer.h"
+#include "command.h"
+#include "txq.h"
+#include "uart.h"
+
+typedef struct {
+    unsigned long t_us;
+    char byte;
+} replay_byte;
+
+static long messages = 0;
+static long errors = 0;
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static replay_byte *load_trace(const char *path, long *count) {
+    FILE *f = fopen(path, "r");
+    char line[64];
+    long cap = 1024, n = 0;
+    replay_byte *bytes = malloc(cap * sizeof(*bytes));
+
+    if (f == NULL || bytes == NULL) {
+        perror(path);
+        exit(1);
+    }
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long t;
+        unsigned int b;
+        if (line[0] == '#' || sscanf(line, "%lu %x", &t, &b) != 2) {
+            continue;
+        }
+        if (n == cap) {
+            cap *= 2;
+            bytes = realloc(bytes, cap * sizeof(*bytes));
+        }
+        bytes[n].t_us = t;
+        bytes[n].byte = (char)b;
+        n++;
+    }
+    fclose(f);
+    *count = n;
+    return bytes;
+}
+
+// one main loop iteration: parse pending bytes, then let the "TX ISR" drain everything
+static void run_loop(void) {
+    char c;
+    int line_start = 1;
+    char type[5];
+    int type_len = 0;
+
+    process_uart(UART_1);
+    txq_pump(UART_1);
+    while (buffer_read(&transmit_buffer1, &c)) {
+        if (line_start) {
+            type_len = 0;
+        }
+        if (type_len < 4) {
+            type[type_len++] = c;
+            if (type_len == 4) {
+                messages += memcmp(type, "$MSG", 4) == 0;
+                errors += memcmp(type, "$ERR", 4) == 0;
+            }
+        }
+        line_start = (c == '\n');
+        if (transmit_buffer1.count == 0) {
+            txq_pump(UART_1);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int real_time = 0;
+    unsigned long period_us = 10000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "rp:")) != -1) {
+        if (opt == 'r') {
+            real_time = 1;
+        } else if (opt == 'p') {
+            period_us = strtoul(optarg, NULL, 10);
+        } else {
+            optind = argc + 1;
+        }
+    }
+    if (optind != argc - 1 || period_us == 0) {
+        fprintf(stderr, "usage: %s [-r] [-p period_us] trace.txt\n", argv[0]);
+        return 1;
+    }
+
+    long count, dropped = 0;
+    replay_byte *bytes = load_trace(argv[optind], &count);
+    unsigned long next_loop = period_us;
+
+    buffer_init(&main_buffer_1);
+    buffer_init(&transmit_buffer1);
+    command_init();
+
+    double start = now_s();
+    for (long i = 0; i < count; i++) {
+        while (bytes[i].t_us >= next_loop) {
+            run_loop();
+            next_loop += period_us;
+        }
+        if (real_time) {
+            double wait = start + bytes[i].t_us * 1e-6 - now_s();
+            if (wait > 0) {
+                struct timespec ts = { (time_t)wait, (long)((wait - (time_t)wait) * 1e9) };
+                nanosleep(&ts, NULL);
+            }
+        }
+        if (!buffer_write(&main_buffer_1, bytes[i].byte)) {
+            dropped++;
+        }
+        if (bytes[i].byte == '*') {
+            run_loop(); // EVENT_RX_FRAME
+        }
+    }
+    run_loop();
+    double wall = now_s() - start;
+    double trace_s = count ? bytes[count - 1].t_us * 1e-6 : 0;
+
+    unsigned int tx_dropped = 0;
+    for (int p = 0; p < TXQ_PRIO_COUNT; p++) {
+        tx_dropped += txq_stats_1.dropped[p];
+    }
+    printf("bytes,messages,errors,dropped_bytes,parser_resets,tx_dropped,trace_s,wall_s,msgs_per_s\n");
+    printf("%ld,%ld,%ld,%ld,%u,%u,%.6f,%.6f,%.1f\n", count, messages, errors, dropped,
+           ps_1.resets, tx_dropped, trace_s, wall, wall > 0 ? messages / wall : 0.0);
+    free(bytes);
+    return 0;
+}
@@ -0,0 +1,988 @@
+/*
+ * File:   sim.c
+ * Author: EMBG2
+ *
+ * Virtual time simulator: runs the unmodified firmware (main loop of
+ * newmainXC16.c and every interrupt) against models of the peripherals,
+ * much faster than real time, for soak tests of the command and
+ * telemetry traffic.
+ *
+ * Built with HOST_SIM, host/xc.h routes every register access through
+ * host_sim_touch(). Each access costs SIM_TOUCH_CYCLES of virtual time;
+ * the code between two accesses takes none. The same register accessed
+ * twice in a row from the same place is a busy wait, and virtual time
+ * jumps ahead until an event changes it. Idle() does the same until an
+ * enabled interrupt is pending. An access only commits the peripherals
+ * whose registers were written since the previous one, and the event list
+ * and the interrupt flags are only scanned when something can have changed.
+ * SPI1 bytes skip the polls of spi_transfer() altogether (host_sim_spi).
+ * Speed: a 24 hour soak with the default commands takes 17 to 21 s of wall
+ * time on one desktop core. What is left is about 30 million accesses per
+ * simulated hour, mostly the UART interrupts and the main loop. Models:
+ *   - Timer1/2 and Timer4/5 (32-bit) with their period flags, Timer3 free running
+ *   - UART1/2 at the configured BRG: 4 byte FIFOs both ways, 10 bit frames,
+ *     OERR, UTXISEL transmit interrupt modes
+ *   - SPI1 byte timing from the prescalers, with the accelerometer, gyro and
+ *     magnetometer selected by their chip select lines. The magnetometer
+ *     answers 0x40 (chip id) and 0x42..0x47 from a slowly rotating field,
+ *     or from recorded "x,y,z" lines (one per read, e.g. mzdecode output)
+ *   - a host PC on the other end of UART1 (and UART2 with -s) sending one
+ *     command per period, and reading every line sent back
+ *
+ * Build and run from the repository root:
+ *   gcc -std=gnu99 -O2 -DHOST_SIM -Dmain=firmware_main -Ihost -I. host/sim.c host/xc.c newmainXC16.c timer.c uart.c spi.c parser.c buffer.c mag.c command.c trace.c txq.c calib.c dsp.c dspcost.c imu.c heading.c fixmath.c ahrs.c magacq.c event.c clock.c timesync.c capture.c stats.c prof.c route.c magz.c seqlock.c rategen.c shed.c -o sim -lm
+ *   ./sim [-t hours] [-c command_period_ms] [-m mag.csv] [-s script.txt]
+ *     -t  virtual time to run (default 24)
+ *     -c  period of the host commands (default 1000)
+ *     -m  recorded magnetometer samples
+ *     -s  commands to cycle through instead of the built-in list,
+ *         one "<uart> <command>" per line, e.g. "1 $RATE,10*"
+ *
+ * Prints CSV, one line per UART:
+ *   uart,tx_bytes,tx_util,lines,mag_lines,mz_samples,yaw_lines,cmds,echo_lat_mean_ms,echo_lat_max_ms,rx_overruns
+ * then one line for the whole run:
+ *   sim_s,wall_s,speedup,ticks,mag_period_mean_ms,mag_period_max_ms,txq_dropped,tx_dropped_msgs,rx_dropped,parser_resets,event_overflows,shed_overruns
+ */
+
+#define _XOPEN_SOURCE 600
+#define HOST_SIM_STORAGE // the simulator works on the registers directly
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <time.h>
+#include <math.h>
+#include "xc.h"
+#include "uart.h"
+#include "buffer.h"
+#include "command.h"
+#include "txq.h"
+#include "stats.h"
+#include "event.h"
+#include "shed.h"
+#undef main
+
+#define SIM_TOUCH_CYCLES 4    // virtual cost of one register access
+#define SIM_NEVER UINT64_MAX
+#define SIM_EMPTY 0xFFFFu     // data register value meaning "nothing written since"
+#define SIM_RECEIVED 0x100u   // SPI1BUF holds a received byte, not one written to send
+#define SIM_FIFO 4
+#define SIM_HOST_QUEUE 1024
+#define SIM_LINE_MAX 256
+#define SIM_UARTS 2
+#define SIM_COMMANDS_MAX 64
+
+// UxMODE / UxSTA bits, as used by uart.c
+#define MODE_BRGH (1u << 3)
+#define MODE_UARTEN (1u << 15)
+#define STA_URXDA (1u << 0)
+#define STA_OERR (1u << 1)
+#define STA_TRMT (1u << 8)
+#define STA_UTXBF (1u << 9)
+#define STA_UTXEN (1u << 10)
+#define STA_UTXISEL0 (1u << 13)
+#define STA_UTXISEL1 (1u << 15)
+
+typedef uint64_t cycles;
+
+int firmware_main(void);
+void _T2Interrupt(void);
+void _T5Interrupt(void);
+
+typedef struct {
+    volatile unsigned int *ifs;
+    volatile unsigned int *iec;
+    unsigned int bit;
+    void (*isr)(void);
+} sim_vector;
+
+// natural order priority, all at the default level 4
+static const sim_vector vectors[] = {
+    {&IFS0, &IEC0, 1u << 7, _T2Interrupt},
+    {&IFS0, &IEC0, 1u << 11, _U1RXInterrupt},
+    {&IFS0, &IEC0, 1u << 12, _U1TXInterrupt},
+    {&IFS1, &IEC1, 1u << 12, _T5Interrupt},
+    {&IFS1, &IEC1, 1u << 14, _U2RXInterrupt},
+    {&IFS1, &IEC1, 1u << 15, _U2TXInterrupt},
+};
+#define SIM_VECTORS (int)(sizeof(vectors) / sizeof(vectors[0]))
+
+typedef struct {
+    int on;
+    cycles tick;      // cycles per count
+    uint64_t period;  // counts per period, PR + 1
+    cycles base;      // start of the current period
+    cycles next;      // end of the current period, SIM_NEVER without a flag to raise
+} sim_timer;
+
+typedef struct {
+    volatile unsigned int *mode, *sta, *brg, *txreg, *rxreg, *ifs;
+    unsigned int rx_if, tx_if;
+    int utxen;
+    int tx_fifo[SIM_FIFO];
+    int tx_count;
+    int tsr;                         // byte being shifted out, -1 when idle
+    cycles tx_done;
+    uint8_t rx_fifo[SIM_FIFO];
+    int rx_count;
+    // the host PC on the other end
+    char host_queue[SIM_HOST_QUEUE];
+    int host_head, host_count;
+    cycles host_next;                // arrival of the next host byte
+    cycles echo_sent[SIM_COMMANDS_MAX]; // '*' of commands not echoed yet
+    int echo_head, echo_count;
+    char line[SIM_LINE_MAX];
+    int line_len;
+    // metrics
+    unsigned long tx_bytes, lines, mag_lines, mz_samples, yaw_lines, cmds, echoes, rx_overruns;
+    cycles echo_total, echo_max;
+} sim_uart;
+
+typedef struct {
+    volatile unsigned int *lat;  // LATB / LATD word
+    unsigned int cs;
+    uint8_t regs[128];
+    int index;                   // bytes since chip select
+    uint8_t addr;
+    int read;
+    uint8_t data_reg;            // first data register, refreshed when a burst starts there
+} sim_device;
+
+static cycles now;
+static cycles next_due;   // no event before this, set by run_events and lowered by sim_schedule
+// peripherals with registers accessed since the last sync, the only ones
+// whose writes need committing. Kept as a mask because an interrupt taken
+// inside an access makes accesses of its own before the outer one returns
+enum { DIRTY_TIMERS = 1, DIRTY_UARTS = 2, DIRTY_SPI = 4, DIRTY_IRQ = 8, DIRTY_ALL = 15 };
+static int dirty = DIRTY_ALL;
+// the register handed out by the last access and what it held then: its
+// peripheral only needs a sync if the firmware wrote something else to it,
+// most accesses are reads
+static volatile unsigned int *written_sfr;
+static unsigned int written_value;
+static int written_group;
+static int irq_check = 1; // an interrupt may have become pending or unmasked
+static cycles end_time;
+static jmp_buf sim_exit;
+static volatile void *last_sfr;
+static void *last_site;
+static int in_isr;
+
+static sim_timer timers[5]; // [1] .. [4], [4] is Timer4/5 in 32-bit mode
+
+static sim_uart uarts[SIM_UARTS] = {
+    {.mode = &U1MODE, .sta = &U1STA, .brg = &U1BRG, .txreg = &U1TXREG, .rxreg = &U1RXREG,
+     .ifs = &IFS0, .rx_if = 1u << 11, .tx_if = 1u << 12},
+    {.mode = &U2MODE, .sta = &U2STA, .brg = &U2BRG, .txreg = &U2TXREG, .rxreg = &U2RXREG,
+     .ifs = &IFS1, .rx_if = 1u << 14, .tx_if = 1u << 15},
+};
+
+static int spi_busy;
+static cycles spi_done;
+static cycles spi_others;        // no other event before this while the byte is sent, 0 if not known
+static unsigned int spi_response;
+
+enum { DEV_ACC, DEV_GYR, DEV_MAG, DEV_COUNT };
+static sim_device devices[DEV_COUNT] = {
+    {.lat = &LATB, .cs = 1u << 3, .data_reg = 0x02},
+    {.lat = &LATB, .cs = 1u << 4, .data_reg = 0x02},
+    {.lat = &LATD, .cs = 1u << 6, .data_reg = 0x42},
+};
+
+static int16_t (*mag_samples)[3];
+static long mag_sample_count, mag_reads;
+static uint32_t noise_state = 12345;
+
+typedef struct {
+    int uart;
+    char text[100];
+} sim_command;
+
+static sim_command commands[SIM_COMMANDS_MAX] = {
+    {1, "$STAT*"}, {1, "$RATE,10*"}, {1, "$SHED*"}, {1, "$RATE,2.5*"}, {1, "$ROUTE,MAG*"},
+    {1, "$TS,1*"}, {1, "$AHRS,COST*"}, {1, "$TS,0*"}, {1, "$RATE,5*"},
+};
+static int command_count = 9;
+static int command_next;
+static cycles command_period;
+static cycles command_time;
+
+static cycles mag_last, mag_period_total, mag_period_max;
+static unsigned long mag_periods;
+
+static void sim_advance(void);
+
+// a peripheral event was scheduled at, run_events must not be skipped past it
+static void sim_schedule(cycles at) {
+    if (at < next_due) {
+        next_due = at;
+    }
+    if (at < spi_others) {
+        spi_others = at;
+    }
+}
+
+static int noise(int span) {
+    noise_state = noise_state * 1103515245u + 12345u;
+    return (int)((noise_state >> 16) % (2 * span + 1)) - span;
+}
+
+// ---- timers
+
+static int timer_on(int t) {
+    switch (t) {
+        case 1: return T1CONbits.TON;
+        case 2: return T2CONbits.TON;
+        case 3: return T3CONbits.TON;
+        default: return T4CONbits.TON && T4CONbits.T32;
+    }
+}
+
+static int timer_prescale(int t) {
+    static const int prescale[4] = {1, 8, 64, 256};
+    switch (t) {
+        case 1: return prescale[T1CONbits.TCKPS];
+        case 2: return prescale[T2CONbits.TCKPS];
+        case 3: return prescale[T3CONbits.TCKPS];
+        default: return prescale[T4CONbits.TCKPS];
+    }
+}
+
+static uint64_t timer_period(int t) {
+    switch (t) {
+        case 1: return (uint64_t)PR1 + 1;
+        case 2: return (uint64_t)PR2 + 1;
+        case 3: return (uint64_t)PR3 + 1;
+        default: return (((uint64_t)PR5 << 16) | PR4) + 1;
+    }
+}
+
+static uint32_t timer_stored(int t) {
+    switch (t) {
+        case 1: return TMR1;
+        case 2: return TMR2;
+        case 3: return TMR3;
+        default: return ((uint32_t)TMR5 << 16) | TMR4;
+    }
+}
+
+static void timer_store(int t, uint32_t count) {
+    switch (t) {
+        case 1: TMR1 = count; break;
+        case 2: TMR2 = count; break;
+        case 3: TMR3 = count; break;
+        default:
+            TMR4 = count & 0xFFFF;
+            TMR5 = TMR5HLD = count >> 16; // reading TMR4 latches TMR5 into TMR5HLD
+            break;
+    }
+}
+
+// read on every TMRx access, so the divisions are skipped where they can
+// be: Timer3 counts at FCY, the others restart their base every period
+static uint32_t timer_count(int t) {
+    sim_timer *tm = &timers[t];
+    uint64_t count = now - tm->base;
+    if (tm->tick != 1) {
+        count /= tm->tick;
+    }
+    if (count < tm->period) {
+        return (uint32_t)count;
+    }
+    if ((tm->period & (tm->period - 1)) == 0) {
+        return (uint32_t)(count & (tm->period - 1));
+    }
+    return (uint32_t)(count % tm->period);
+}
+
+static void timer_sync(int t) {
+    sim_timer *tm = &timers[t];
+    int on = timer_on(t);
+    if (on == tm->on) {
+        return;
+    }
+    if (on) {
+        tm->tick = timer_prescale(t);
+        tm->period = timer_period(t);
+        uint64_t count = timer_stored(t) % tm->period;
+        tm->base = now - count * tm->tick;
+        // Timer3 is read only, it needs no events
+        tm->next = t == 3 ? SIM_NEVER : tm->base + tm->period * tm->tick;
+        sim_schedule(tm->next);
+    } else {
+        timer_store(t, timer_count(t));
+        tm->next = SIM_NEVER;
+    }
+    tm->on = on;
+}
+
+static void timer_expire(int t) {
+    sim_timer *tm = &timers[t];
+    tm->base = tm->next;
+    tm->next += tm->period * tm->tick;
+    if (t == 1) {
+        IFS0bits.T1IF = 1;
+    } else if (t == 2) {
+        IFS0bits.T2IF = 1;
+    } else {
+        IFS1bits.T5IF = 1;
+    }
+}
+
+// ---- UARTs
+
+static cycles byte_cycles(const sim_uart *u) {
+    cycles bit = ((*u->mode & MODE_BRGH) ? 4 : 16) * ((cycles)*u->brg + 1);
+    return 10 * bit;
+}
+
+static void uart_status(sim_uart *u) {
+    unsigned int sta = *u->sta & ~(STA_URXDA | STA_TRMT | STA_UTXBF);
+    if (u->rx_count > 0) {
+        sta |= STA_URXDA;
+    }
+    if (u->tsr < 0 && u->tx_count == 0) {
+        sta |= STA_TRMT;
+    }
+    if (u->tx_count == SIM_FIFO) {
+        sta |= STA_UTXBF;
+    }
+    *u->sta = sta;
+}
+
+static void uart_tx_load(sim_uart *u, cycles at) {
+    if (u->tsr >= 0 || u->tx_count == 0) {
+        return;
+    }
+    u->tsr = u->tx_fifo[0];
+    memmove(u->tx_fifo, u->tx_fifo + 1, sizeof(int) * --u->tx_count);
+    u->tx_done = at + byte_cycles(u);
+    sim_schedule(u->tx_done);
+    unsigned int sel = *u->sta & (STA_UTXISEL0 | STA_UTXISEL1);
+    if (sel == 0 || (sel == STA_UTXISEL1 && u->tx_count == 0)) {
+        *u->ifs |= u->tx_if; // a character moved into the shift register
+    }
+}
+
+static void host_line(sim_uart *u, cycles at) {
+    const char *l = u->line;
+    u->lines++;
+    if (strncmp(l, "$MSG,", 5) == 0 && u->echo_count > 0) {
+        cycles lat = at - u->echo_sent[u->echo_head];
+        u->echo_head = (u->echo_head + 1) % SIM_COMMANDS_MAX;
+        u->echo_count--;
+        u->echoes++;
+        u->echo_total += lat;
+        if (lat > u->echo_max) {
+            u->echo_max = lat;
+        }
+    } else if (strncmp(l, "$MAG,", 5) == 0) {
+        u->mag_lines++;
+        if (u == &uarts[0]) {
+            if (mag_last != 0) {
+                cycles period = at - mag_last;
+                mag_period_total += period;
+                mag_periods++;
+                if (period > mag_period_max) {
+                    mag_period_max = period;
+                }
+            }
+            mag_last = at;
+        }
+    } else if (strncmp(l, "$MZ,", 4) == 0) {
+        unsigned int seq, key, n;
+        if (sscanf(l, "$MZ,%u,%u,%u,", &seq, &key, &n) == 3) {
+            u->mz_samples += n;
+        }
+    } else if (strncmp(l, "$YAW,", 5) == 0) {
+        u->yaw_lines++;
+    }
+}
+
+// a byte arrived at the host
+static void host_receive(sim_uart *u, char c, cycles at) {
+    u->tx_bytes++;
+    if (c == '\n') {
+        u->line[u->line_len] = '\0';
+        host_line(u, at);
+        u->line_len = 0;
+    } else if (u->line_len < SIM_LINE_MAX - 1) {
+        u->line[u->line_len++] = c;
+    }
+}
+
+static void uart_tx_complete(sim_uart *u) {
+    cycles at = u->tx_done;
+    host_receive(u, (char)u->tsr, at);
+    u->tsr = -1;
+    if (u->tx_count > 0) {
+        uart_tx_load(u, at);
+    } else if ((*u->sta & (STA_UTXISEL0 | STA_UTXISEL1)) == STA_UTXISEL0) {
+        *u->ifs |= u->tx_if; // the last bit went out
+    }
+    uart_status(u);
+}
+
+static void uart_sync(sim_uart *u) {
+    int utxen = (*u->mode & MODE_UARTEN) && (*u->sta & STA_UTXEN);
+    if (utxen && !u->utxen) {
+        *u->ifs |= u->tx_if; // the transmit buffer is empty
+    }
+    u->utxen = utxen;
+    if (*u->txreg != SIM_EMPTY) {
+        if (u->tx_count < SIM_FIFO) {
+            u->tx_fifo[u->tx_count++] = *u->txreg & 0xFF;
+        }
+        *u->txreg = SIM_EMPTY;
+        uart_tx_load(u, now);
+    }
+    uart_status(u);
+}
+
+// a byte from the host reaches the receiver
+static void uart_rx_arrive(sim_uart *u) {
+    cycles at = u->host_next;
+    char c = u->host_queue[u->host_head];
+    u->host_head = (u->host_head + 1) % SIM_HOST_QUEUE;
+    u->host_count--;
+    u->host_next = u->host_count > 0 ? at + byte_cycles(u) : SIM_NEVER;
+
+    if (!(*u->mode & MODE_UARTEN)) {
+        return;
+    }
+    if (*u->sta & STA_OERR) {
+        u->rx_overruns++; // the receiver stops until OERR is cleared
+        return;
+    }
+    if (u->rx_count == SIM_FIFO) {
+        *u->sta |= STA_OERR;
+        u->rx_overruns++;
+        return;
+    }
+    u->rx_fifo[u->rx_count++] = (uint8_t)c;
+    if (c == '*' && u->echo_count < SIM_COMMANDS_MAX) {
+        u->echo_sent[(u->echo_head + u->echo_count++) % SIM_COMMANDS_MAX] = at;
+    }
+    *u->ifs |= u->rx_if;
+    uart_status(u);
+}
+
+static void host_send(sim_uart *u, const char *text) {
+    int was_empty = u->host_count == 0;
+    for (; *text != '\0' && u->host_count < SIM_HOST_QUEUE; text++) {
+        u->host_queue[(u->host_head + u->host_count++) % SIM_HOST_QUEUE] = *text;
+        if (*text == '*') {
+            u->cmds++;
+        }
+    }
+    if (was_empty && u->host_count > 0) {
+        u->host_next = now + byte_cycles(u);
+        sim_schedule(u->host_next);
+    }
+}
+
+// ---- SPI and the sensors
+
+static void device_refresh(int dev) {
+    uint8_t *r = devices[dev].regs;
+    double t = now / (double)FCY;
+    int16_t v[3];
+    if (dev == DEV_MAG) {
+        if (mag_sample_count > 0) {
+            memcpy(v, mag_samples[mag_reads++ % mag_sample_count], sizeof(v));
+        } else {
+            double a = 2 * M_PI * t / 60; // one turn per minute
+            v[0] = (int16_t)(300 * cos(a)) + noise(2);
+            v[1] = (int16_t)(300 * sin(a)) + noise(2);
+            v[2] = -400 + noise(2);
+        }
+        // x / y: 13 bits left aligned by 3, z: 15 bits left aligned by 1
+        for (int i = 0; i < 3; i++) {
+            uint16_t raw = (uint16_t)(v[i] * (i < 2 ? 8 : 2));
+            r[0x42 + 2 * i] = raw & 0xFF;
+            r[0x43 + 2 * i] = raw >> 8;
+        }
+    } else if (dev == DEV_ACC) {
+        int16_t acc[3] = {(int16_t)noise(3), (int16_t)noise(3), (int16_t)(1024 + noise(3))};
+        for (int i = 0; i < 3; i++) {
+            uint16_t raw = (uint16_t)(acc[i] * 16); // 12 bits left aligned
+            r[0x02 + 2 * i] = raw & 0xF0;
+            r[0x03 + 2 * i] = raw >> 8;
+        }
+    } else {
+        for (int i = 0; i < 3; i++) {
+            uint16_t raw = (uint16_t)noise(4);
+            r[0x02 + 2 * i] = raw & 0xFF;
+            r[0x03 + 2 * i] = raw >> 8;
+        }
+    }
+}
+
+static unsigned int device_transfer(int dev, uint8_t out) {
+    sim_device *d = &devices[dev];
+    unsigned int in = 0xFF;
+    if (d->index == 0) {
+        d->addr = out & 0x7F;
+        d->read = (out & 0x80) != 0;
+    } else {
+        uint8_t reg = (d->addr + d->index - 1) & 0x7F;
+        if (d->read) {
+            if (d->index == 1 && reg == d->data_reg) {
+                device_refresh(dev);
+            }
+            in = d->regs[reg];
+        } else {
+            d->regs[reg] = out;
+        }
+    }
+    d->index++;
+    return in;
+}
+
+static void spi_sync(void) {
+    for (int i = 0; i < DEV_COUNT; i++) {
+        if (*devices[i].lat & devices[i].cs) {
+            devices[i].index = 0; // deselected, the next byte is an address
+        }
+    }
+}
+
+// the byte written to SPI1BUF goes out
+static void spi_start(void) {
+    static const int primary[4] = {64, 16, 4, 1};
+    cycles bit = (cycles)primary[SPI1CON1bits.PPRE] * (8 - SPI1CON1bits.SPRE);
+    uint8_t out = SPI1BUF & 0xFF;
+    spi_response = 0xFF; // nobody selected: the line floats high
+    for (int i = 0; i < DEV_COUNT; i++) {
+        if (!(*devices[i].lat & devices[i].cs)) {
+            spi_response = device_transfer(i, out);
+        }
+    }
+    cycles others = next_due;
+    spi_busy = 1;
+    spi_done = now + 8 * bit;
+    sim_schedule(spi_done);
+    spi_others = others;
+}
+
+static void spi_complete(void) {
+    spi_busy = 0;
+    SPI1BUF = SIM_RECEIVED | spi_response;
+}
+
+// ---- virtual time
+
+static cycles next_event(void) {
+    cycles next = command_time;
+    for (int t = 1; t <= 4; t++) {
+        if (timers[t].on && timers[t].next < next) {
+            next = timers[t].next;
+        }
+    }
+    for (int i = 0; i < SIM_UARTS; i++) {
+        sim_uart *u = &uarts[i];
+        if (u->tsr >= 0 && u->tx_done < next) {
+            next = u->tx_done;
+        }
+        if (u->host_count > 0 && u->host_next < next) {
+            next = u->host_next;
+        }
+    }
+    if (spi_busy && spi_done < next) {
+        next = spi_done;
+    }
+    return next;
+}
+
+// runs every event due up to now, in time order
+static void run_events(void) {
+    for (;;) {
+        cycles at = next_event();
+        if (at > now) {
+            next_due = at;
+            spi_others = 0;
+            return;
+        }
+        irq_check = 1;
+        if (at == command_time) {
+            sim_command *c = &commands[command_next];
+            command_next = (command_next + 1) % command_count;
+            host_send(&uarts[c->uart - 1], c->text);
+            command_time += command_period;
+            continue;
+        }
+        for (int t = 1; t <= 4; t++) {
+            if (timers[t].on && timers[t].next == at) {
+                timer_expire(t);
+            }
+        }
+        for (int i = 0; i < SIM_UARTS; i++) {
+            sim_uart *u = &uarts[i];
+            if (u->tsr >= 0 && u->tx_done == at) {
+                uart_tx_complete(u);
+            }
+            if (u->host_count > 0 && u->host_next == at) {
+                uart_rx_arrive(u);
+            }
+        }
+        if (spi_busy && spi_done == at) {
+            spi_complete();
+        }
+    }
+}
+
+// the models that depend on what the firmware writes to sfr
+static int sfr_group(volatile void *sfr) {
+    if (sfr == &T1CON || sfr == &T2CON || sfr == &T3CON || sfr == &T4CON) {
+        return DIRTY_TIMERS;
+    }
+    for (int i = 0; i < SIM_UARTS; i++) {
+        sim_uart *u = &uarts[i];
+        if (sfr == u->mode || sfr == u->sta || sfr == u->brg || sfr == u->txreg) {
+            return DIRTY_UARTS;
+        }
+    }
+    if (sfr == &SPI1CON1 || sfr == &LATB || sfr == &LATD) {
+        return DIRTY_SPI;
+    }
+    if (sfr == &IFS0 || sfr == &IFS1 || sfr == &IFS5 || sfr == &IEC0 || sfr == &IEC1 || sfr == &IEC5
+        || sfr == &SR) {
+        return DIRTY_IRQ;
+    }
+    return 0;
+}
+
+// sfr_group() of a register, plus SFR_READ when sim_read has work for it,
+// looked up by address rather than compared with every model register
+#define SFR_READ 16
+#define SIM_SFR_SLOTS 256 // more than the registers in host/xc.h
+static struct {
+    volatile void *sfr;
+    int flags;
+} sfr_slots[SIM_SFR_SLOTS];
+
+static int sfr_reads(volatile void *sfr) {
+    if (sfr == &TMR1 || sfr == &TMR2 || sfr == &TMR3 || sfr == &TMR4) {
+        return 1;
+    }
+    for (int i = 0; i < SIM_UARTS; i++) {
+        if (sfr == uarts[i].rxreg) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int sfr_flags(volatile void *sfr) {
+    unsigned int h = ((uintptr_t)sfr >> 2) % SIM_SFR_SLOTS;
+    while (sfr_slots[h].sfr != sfr) {
+        if (sfr_slots[h].sfr == NULL) {
+            sfr_slots[h].sfr = sfr;
+            sfr_slots[h].flags = sfr_group(sfr) | (sfr_reads(sfr) ? SFR_READ : 0);
+            break;
+        }
+        h = (h + 1) % SIM_SFR_SLOTS;
+    }
+    return sfr_slots[h].flags;
+}
+
+static void sim_written(void) {
+    if (written_group && *written_sfr != written_value) {
+        dirty |= written_group;
+    }
+    written_group = 0;
+}
+
+// commits what the firmware wrote since the last access, then catches up
+static void sim_sync(void) {
+    sim_written();
+    int d = dirty;
+    dirty = 0;
+    if (d & DIRTY_TIMERS) {
+        for (int t = 1; t <= 4; t++) {
+            timer_sync(t);
+        }
+    }
+    if (d & (DIRTY_UARTS | DIRTY_IRQ)) {
+        irq_check = 1; // uart_sync can raise a transmit flag
+    }
+    if (d & DIRTY_UARTS) {
+        for (int i = 0; i < SIM_UARTS; i++) {
+            uart_sync(&uarts[i]);
+        }
+    }
+    if (d & DIRTY_SPI) {
+        spi_sync();
+    }
+    // only scan the events when one may be due, most accesses fall between two
+    if (now >= next_due) {
+        run_events();
+    }
+}
+
+static void sim_advance(void) {
+    cycles next = next_event();
+    if (next > end_time) {
+        next = end_time;
+    }
+    if (next > now) {
+        now = next;
+    }
+    if (now >= end_time) {
+        longjmp(sim_exit, 1);
+    }
+    run_events();
+}
+
+static int sim_pending(void) {
+    for (int i = 0; i < SIM_VECTORS; i++) {
+        if (*vectors[i].ifs & *vectors[i].iec & vectors[i].bit) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void sim_dispatch(void) {
+    int v;
+    if (in_isr) {
+        return; // one priority level, no nesting
+    }
+    if (!irq_check) {
+        return; // nothing raised, enabled or unmasked since the last look
+    }
+    irq_check = 0;
+    // an interrupt taken between two polls does not end the busy wait
+    volatile void *sfr = last_sfr;
+    void *site = last_site;
+    while (SRbits.IPL < 4 && (v = sim_pending()) >= 0) {
+        in_isr = 1;
+        vectors[v].isr();
+        in_isr = 0;
+        sim_written(); // the last register the interrupt wrote
+    }
+    last_sfr = sfr;
+    last_site = site;
+}
+
+// the firmware is about to read sfr
+static void sim_read(volatile void *sfr) {
+    for (int t = 1; t <= 3; t++) {
+        volatile unsigned int *tmr = t == 1 ? &TMR1 : t == 2 ? &TMR2 : &TMR3;
+        if (sfr == tmr && timers[t].on) {
+            timer_store(t, timer_count(t));
+        }
+    }
+    if (sfr == &TMR4 && timers[4].on) {
+        timer_store(4, timer_count(4));
+    }
+    for (int i = 0; i < SIM_UARTS; i++) {
+        sim_uart *u = &uarts[i];
+        if (sfr == u->rxreg && u->rx_count > 0) {
+            *u->rxreg = u->rx_fifo[0];
+            memmove(u->rx_fifo, u->rx_fifo + 1, --u->rx_count);
+            uart_status(u);
+        }
+    }
+}
+
+volatile void *host_sim_touch(volatile void *sfr) {
+    void *site = __builtin_return_address(0);
+    if (sfr == last_sfr && site == last_site) {
+        // the same register again with nothing in between: a busy wait. It
+        // lasts until an event changes the register, with the interrupts
+        // due meanwhile taken. Counters and data registers only change
+        // when read, for those one event at a time
+        unsigned int value = *(volatile unsigned int *)sfr;
+        sim_sync();
+        do {
+            sim_advance();
+            irq_check = 1;
+            sim_dispatch();
+        } while (!(sfr_flags(sfr) & SFR_READ) && *(volatile unsigned int *)sfr == value);
+    }
+    now += SIM_TOUCH_CYCLES;
+    if (now >= end_time) {
+        longjmp(sim_exit, 1);
+    }
+    sim_written();
+    if (dirty || now >= next_due) {
+        sim_sync();
+    }
+    if (irq_check && !in_isr) {
+        sim_dispatch();
+    }
+    int flags = sfr_flags(sfr);
+    if (flags & SFR_READ) {
+        sim_read(sfr);
+    }
+    written_sfr = sfr; // the firmware may write it once this returns
+    written_value = *written_sfr;
+    written_group = flags & DIRTY_ALL;
+    last_sfr = sfr;
+    last_site = site;
+    return sfr;
+}
+
+// spi_transfer() writes SPI1BUF, polls SPI1STAT and reads SPI1BUF back for
+// every byte, most of the register traffic of a soak. SPI1STAT is plain
+// storage with SPIRBF always set, so the polls fall straight through, and
+// SPI1BUF skips the time and interrupt check of host_sim_touch. A byte
+// written to it goes out at the next access, the read of the answer,
+// which returns once the byte is through, taking the interrupts due
+// meanwhile
+volatile void *host_sim_spi(volatile void *sfr) {
+    sim_written();
+    if (dirty || now >= next_due) {
+        sim_sync();
+    }
+    if (!(SPI1BUF & SIM_RECEIVED) && SPI1STATbits.SPIEN && !in_isr) {
+        spi_start();
+        // nothing else happens before the byte is through: skip the event scan
+        if (spi_done < spi_others && spi_done < end_time) {
+            now = spi_done;
+            spi_complete();
+            next_due = spi_others;
+        }
+        while (spi_busy) {
+            sim_advance();
+            irq_check = 1;
+            sim_dispatch();
+        }
+    }
+    last_sfr = sfr;
+    return sfr;
+}
+
+void host_sim_idle(void) {
+    sim_sync();
+    while (sim_pending() < 0) {
+        sim_advance();
+    }
+}
+
+// ---- setup and report
+
+static void load_mag(const char *path) {
+    FILE *f = fopen(path, "r");
+    char line[64];
+    long cap = 0;
+    if (f == NULL) {
+        perror(path);
+        exit(1);
+    }
+    while (fgets(line, sizeof(line), f)) {
+        int x, y, z;
+        if (sscanf(line, "%d,%d,%d", &x, &y, &z) != 3) {
+            continue;
+        }
+        if (mag_sample_count == cap) {
+            cap = cap ? cap * 2 : 1024;
+            mag_samples = realloc(mag_samples, cap * sizeof(*mag_samples));
+        }
+        mag_samples[mag_sample_count][0] = (int16_t)x;
+        mag_samples[mag_sample_count][1] = (int16_t)y;
+        mag_samples[mag_sample_count][2] = (int16_t)z;
+        mag_sample_count++;
+    }
+    fclose(f);
+}
+
+static void load_script(const char *path) {
+    FILE *f = fopen(path, "r");
+    char line[128];
+    if (f == NULL) {
+        perror(path);
+        exit(1);
+    }
+    command_count = 0;
+    while (fgets(line, sizeof(line), f) && command_count < SIM_COMMANDS_MAX) {
+        sim_command *c = &commands[command_count];
+        if (sscanf(line, "%d %99s", &c->uart, c->text) == 2 && c->uart >= 1 && c->uart <= SIM_UARTS) {
+            command_count++;
+        }
+    }
+    fclose(f);
+    if (command_count == 0) {
+        fprintf(stderr, "%s: no commands\n", path);
+        exit(1);
+    }
+}
+
+static double ms(cycles c) {
+    return c * 1000.0 / FCY;
+}
+
+static double wall_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+    double hours = 24;
+    double period_ms = 1000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            hours = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            period_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            load_mag(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            load_script(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-t hours] [-c command_period_ms] [-m mag.csv] [-s script.txt]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (hours <= 0 || period_ms <= 0) {
+        fprintf(stderr, "hours and command period must be positive\n");
+        return 1;
+    }
+
+    end_time = (cycles)(hours * 3600 * FCY);
+    command_period = (cycles)(period_ms * FCY / 1000);
+    command_time = command_period;
+    for (int t = 1; t <= 4; t++) {
+        timers[t].next = SIM_NEVER;
+    }
+    for (int i = 0; i < SIM_UARTS; i++) {
+        *uarts[i].txreg = SIM_EMPTY;
+        uarts[i].tsr = -1;
+        uarts[i].host_next = SIM_NEVER;
+    }
+    SPI1BUF = SIM_EMPTY;
+    SPI1STATbits.SPIRBF = 1; // see host_sim_spi
+    LATB = LATD = 0xFFFF; // chip selects idle high until spi_init drives them
+    devices[DEV_MAG].regs[0x40] = 0x32; // chip id
+
+    double start = wall_s();
+    if (setjmp(sim_exit) == 0) {
+        firmware_main();
+    }
+    double wall = wall_s() - start;
+
+    printf("uart,tx_bytes,tx_util,lines,mag_lines,mz_samples,yaw_lines,cmds,echo_lat_mean_ms,echo_lat_max_ms,rx_overruns\n");
+    for (int i = 0; i < SIM_UARTS; i++) {
+        sim_uart *u = &uarts[i];
+        printf("%d,%lu,%.3f,%lu,%lu,%lu,%lu,%lu,%.2f,%.2f,%lu\n", i + 1, u->tx_bytes,
+               u->tx_bytes * (double)byte_cycles(u) / now, u->lines, u->mag_lines, u->mz_samples, u->yaw_lines,
+               u->cmds, u->echoes ? ms(u->echo_total) / u->echoes : 0.0, ms(u->echo_max), u->rx_overruns);
+    }
+
+    unsigned long txq_dropped = 0;
+    for (int p = 0; p < TXQ_PRIO_COUNT; p++) {
+        txq_dropped += txq_stats_1.dropped[p] + txq_stats_2.dropped[p];
+    }
+    printf("sim_s,wall_s,speedup,ticks,mag_period_mean_ms,mag_period_max_ms,txq_dropped,tx_dropped_msgs,rx_dropped,parser_resets,event_overflows,shed_overruns\n");
+    printf("%.1f,%.2f,%.0f,%u,%.2f,%.2f,%lu,%u,%u,%u,%u,%u\n", now / (double)FCY, wall,
+           wall > 0 ? now / (double)FCY / wall : 0.0, stats.isr[STAT_ISR_T2],
+           mag_periods ? ms(mag_period_total) / mag_periods : 0.0, ms(mag_period_max), txq_dropped,
+           tx_stats_1.dropped_msgs + tx_stats_2.dropped_msgs, stats.rx_dropped[0] + stats.rx_dropped[1],
+           ps_1.resets + ps_2.resets, event_overflows, shed.overruns);
+    free(mag_samples);
+    return 0;
+}
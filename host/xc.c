@@ -0,0 +1,18 @@
+/*
+ * File:   xc.c
+ * Author: EMBG2
+ *
+ * Storage for the host stand-in SFRs declared in host/xc.h.
+ */
+
+#define HOST_SIM_STORAGE // the storage itself, never the simulator hooks
+#include "xc.h"
+
+// the word view is the same storage as the bits view
+#define HOST_SFR_DEFINE(name, fields) \
+    volatile name##BITS name##bits; \
+    extern volatile unsigned int name __attribute__((alias(#name "bits")));
+#define HOST_REG_DEFINE(name) volatile unsigned int name;
+
+HOST_SFR_LIST(HOST_SFR_DEFINE)
+HOST_REG_LIST(HOST_REG_DEFINE)
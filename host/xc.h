@@ -0,0 +1,169 @@
+/* 
+ * File:   xc.h
+ * Author: EMBG2
+ * Comments: host stand-in for the XC16 device header. Every SFR used by the
+ *           firmware is a plain variable (defined in host/xc.c) so the
+ *           modules can be compiled and exercised with a desktop compiler.
+ * Revision history: 
+ */
+
+#ifndef HOST_XC_H
+#define	HOST_XC_H
+
+#include <stdint.h>
+
+#ifndef __HOST__
+#define __HOST__ 1
+#endif
+
+// XC16 interrupt attributes have no meaning on the host
+#define __interrupt__ __unused__
+#define auto_psv
+// PWRSAV returns at once, there is nothing to wait for on the host
+#define Idle()
+
+// CPU priority save / restore from the device header
+#define SET_AND_SAVE_CPU_IPL(save_to, ipl) do { (save_to) = SRbits.IPL; SRbits.IPL = (ipl); } while (0)
+#define RESTORE_CPU_IPL(saved_to) do { SRbits.IPL = (saved_to); } while (0)
+
+// registers that are also accessed as whole words (through the UART port
+// table) keep the bit positions of the real device
+#define HOST_UMODE_FIELDS unsigned STSEL:1; unsigned PDSEL:2; unsigned BRGH:1; unsigned URXINV:1; \
+    unsigned ABAUD:1; unsigned LPBACK:1; unsigned WAKE:1; unsigned UEN:2; unsigned :1; unsigned RTSMD:1; \
+    unsigned IREN:1; unsigned USIDL:1; unsigned :1; unsigned UARTEN:1;
+#define HOST_USTA_FIELDS unsigned URXDA:1; unsigned OERR:1; unsigned FERR:1; unsigned PERR:1; \
+    unsigned RIDLE:1; unsigned ADDEN:1; unsigned URXISEL:2; unsigned TRMT:1; unsigned UTXBF:1; \
+    unsigned UTXEN:1; unsigned UTXBRK:1; unsigned :1; unsigned UTXISEL0:1; unsigned UTXINV:1; unsigned UTXISEL1:1;
+
+// X(register, bit fields) for every SFR with a bits view, each also has a word view
+#define HOST_SFR_LIST(X) \
+    X(TRISA, unsigned TRISA0:1; unsigned TRISA1:1;) \
+    X(TRISB, unsigned TRISB3:1; unsigned TRISB4:1;) \
+    X(TRISD, unsigned TRISD6:1;) \
+    X(TRISF, unsigned TRISF12:1; unsigned TRISF13:1;) \
+    X(TRISE, unsigned TRISE0:1; unsigned TRISE1:1; unsigned TRISE2:1; unsigned TRISE3:1; unsigned TRISE4:1; unsigned TRISE5:1;) \
+    X(TRISG, unsigned TRISG9:1;) \
+    X(LATA, unsigned LATA0:1;) \
+    X(LATB, unsigned LATB3:1; unsigned LATB4:1;) \
+    X(LATD, unsigned LATD6:1;) \
+    X(LATE, unsigned LATE0:1; unsigned LATE1:1; unsigned LATE2:1; unsigned LATE3:1; unsigned LATE4:1; unsigned LATE5:1;) \
+    X(LATG, unsigned LATG9:1;) \
+    X(RPINR18, unsigned U1RXR:7;) \
+    X(RPINR19, unsigned U2RXR:7;) \
+    X(RPINR20, unsigned SDI1R:7;) \
+    X(RPOR0, unsigned RP64R:6; unsigned RP65R:6;) \
+    X(RPOR11, unsigned RP108R:6;) \
+    X(RPOR12, unsigned RP109R:6;) \
+    X(SPI1CON1, unsigned MSTEN:1; unsigned MODE16:1; unsigned PPRE:2; unsigned SPRE:3; unsigned CKP:1;) \
+    X(SPI1STAT, unsigned SPIROV:1; unsigned SPIEN:1; unsigned SPITBF:1; unsigned SPIRBF:1;) \
+    X(SR, unsigned IPL:3;) \
+    X(T1CON, unsigned TON:1; unsigned TCKPS:2;) \
+    X(T2CON, unsigned TON:1; unsigned TCKPS:2;) \
+    X(T3CON, unsigned TON:1; unsigned TCKPS:2;) \
+    X(T4CON, unsigned TON:1; unsigned TCKPS:2; unsigned T32:1;) \
+    X(IFS0, unsigned :3; unsigned T1IF:1; unsigned :3; unsigned T2IF:1; unsigned :3; unsigned U1RXIF:1; unsigned U1TXIF:1;) \
+    X(IFS1, unsigned :12; unsigned T5IF:1; unsigned :1; unsigned U2RXIF:1; unsigned U2TXIF:1;) \
+    X(IFS5, unsigned :2; unsigned U3RXIF:1; unsigned U3TXIF:1; unsigned :4; unsigned U4RXIF:1; unsigned U4TXIF:1;) \
+    X(IEC0, unsigned :3; unsigned T1IE:1; unsigned :3; unsigned T2IE:1; unsigned :3; unsigned U1RXIE:1; unsigned U1TXIE:1;) \
+    X(IEC1, unsigned :12; unsigned T5IE:1; unsigned :1; unsigned U2RXIE:1; unsigned U2TXIE:1;) \
+    X(IEC5, unsigned :2; unsigned U3RXIE:1; unsigned U3TXIE:1; unsigned :4; unsigned U4RXIE:1; unsigned U4TXIE:1;) \
+    X(U1MODE, HOST_UMODE_FIELDS) \
+    X(U1STA, HOST_USTA_FIELDS) \
+    X(U2MODE, HOST_UMODE_FIELDS) \
+    X(U2STA, HOST_USTA_FIELDS) \
+    X(U3MODE, HOST_UMODE_FIELDS) \
+    X(U3STA, HOST_USTA_FIELDS) \
+    X(U4MODE, HOST_UMODE_FIELDS) \
+    X(U4STA, HOST_USTA_FIELDS)
+
+// plain word registers
+#define HOST_REG_LIST(X) \
+    X(ANSELA) X(ANSELB) X(ANSELC) X(ANSELD) X(ANSELE) X(ANSELG) \
+    X(SPI1BUF) X(PR1) X(PR2) X(PR3) X(PR4) X(PR5) X(TMR1) X(TMR2) X(TMR3) X(TMR4) X(TMR5) X(TMR5HLD) \
+    X(U1BRG) X(U1TXREG) X(U1RXREG) X(U2BRG) X(U2TXREG) X(U2RXREG) \
+    X(U3BRG) X(U3TXREG) X(U3RXREG) X(U4BRG) X(U4TXREG) X(U4RXREG)
+
+#define HOST_SFR_DECLARE(name, fields) \
+    typedef struct { fields } name##BITS; \
+    extern volatile name##BITS name##bits; \
+    extern volatile unsigned int name;
+#define HOST_REG_DECLARE(name) extern volatile unsigned int name;
+
+HOST_SFR_LIST(HOST_SFR_DECLARE)
+HOST_REG_LIST(HOST_REG_DECLARE)
+
+#if defined(HOST_SIM) && !defined(HOST_SIM_STORAGE)
+// host/sim.c runs the whole firmware in virtual time: every access to a
+// register goes through the simulator first, which commits what was
+// written since the previous access, runs the peripherals and interrupts
+// up to now and skips ahead when the same register is polled in a loop.
+// The word views and the UART data registers keep their plain names so
+// the UART port table can take their addresses; its accesses are hooked
+// through SFR_DEREF. SPI1STAT is left as plain storage, the simulator
+// exchanges each byte when SPI1BUF is read back (host_sim_spi).
+volatile void *host_sim_touch(volatile void *sfr);
+volatile void *host_sim_spi(volatile void *sfr);
+void host_sim_idle(void);
+#define HOST_SIM_TOUCH(sfr) (*(__typeof__(&(sfr)))host_sim_touch(&(sfr)))
+#define HOST_SIM_SPI(sfr) (*(__typeof__(&(sfr)))host_sim_spi(&(sfr)))
+#define SFR_DEREF(reg) (*(__typeof__(reg))host_sim_touch(reg))
+#undef Idle
+#define Idle() host_sim_idle()
+#define TRISAbits HOST_SIM_TOUCH(TRISAbits)
+#define TRISBbits HOST_SIM_TOUCH(TRISBbits)
+#define TRISDbits HOST_SIM_TOUCH(TRISDbits)
+#define TRISFbits HOST_SIM_TOUCH(TRISFbits)
+#define TRISEbits HOST_SIM_TOUCH(TRISEbits)
+#define TRISGbits HOST_SIM_TOUCH(TRISGbits)
+#define LATAbits HOST_SIM_TOUCH(LATAbits)
+#define LATBbits HOST_SIM_TOUCH(LATBbits)
+#define LATDbits HOST_SIM_TOUCH(LATDbits)
+#define LATEbits HOST_SIM_TOUCH(LATEbits)
+#define LATGbits HOST_SIM_TOUCH(LATGbits)
+#define RPINR18bits HOST_SIM_TOUCH(RPINR18bits)
+#define RPINR19bits HOST_SIM_TOUCH(RPINR19bits)
+#define RPINR20bits HOST_SIM_TOUCH(RPINR20bits)
+#define RPOR0bits HOST_SIM_TOUCH(RPOR0bits)
+#define RPOR11bits HOST_SIM_TOUCH(RPOR11bits)
+#define RPOR12bits HOST_SIM_TOUCH(RPOR12bits)
+#define SPI1CON1bits HOST_SIM_TOUCH(SPI1CON1bits)
+#define SRbits HOST_SIM_TOUCH(SRbits)
+#define T1CONbits HOST_SIM_TOUCH(T1CONbits)
+#define T2CONbits HOST_SIM_TOUCH(T2CONbits)
+#define T3CONbits HOST_SIM_TOUCH(T3CONbits)
+#define T4CONbits HOST_SIM_TOUCH(T4CONbits)
+#define IFS0bits HOST_SIM_TOUCH(IFS0bits)
+#define IFS1bits HOST_SIM_TOUCH(IFS1bits)
+#define IFS5bits HOST_SIM_TOUCH(IFS5bits)
+#define IEC0bits HOST_SIM_TOUCH(IEC0bits)
+#define IEC1bits HOST_SIM_TOUCH(IEC1bits)
+#define IEC5bits HOST_SIM_TOUCH(IEC5bits)
+#define U1MODEbits HOST_SIM_TOUCH(U1MODEbits)
+#define U1STAbits HOST_SIM_TOUCH(U1STAbits)
+#define U2MODEbits HOST_SIM_TOUCH(U2MODEbits)
+#define U2STAbits HOST_SIM_TOUCH(U2STAbits)
+#define U3MODEbits HOST_SIM_TOUCH(U3MODEbits)
+#define U3STAbits HOST_SIM_TOUCH(U3STAbits)
+#define U4MODEbits HOST_SIM_TOUCH(U4MODEbits)
+#define U4STAbits HOST_SIM_TOUCH(U4STAbits)
+#define ANSELA HOST_SIM_TOUCH(ANSELA)
+#define ANSELB HOST_SIM_TOUCH(ANSELB)
+#define ANSELC HOST_SIM_TOUCH(ANSELC)
+#define ANSELD HOST_SIM_TOUCH(ANSELD)
+#define ANSELE HOST_SIM_TOUCH(ANSELE)
+#define ANSELG HOST_SIM_TOUCH(ANSELG)
+#define SPI1BUF HOST_SIM_SPI(SPI1BUF)
+#define PR1 HOST_SIM_TOUCH(PR1)
+#define PR2 HOST_SIM_TOUCH(PR2)
+#define PR3 HOST_SIM_TOUCH(PR3)
+#define PR4 HOST_SIM_TOUCH(PR4)
+#define PR5 HOST_SIM_TOUCH(PR5)
+#define TMR1 HOST_SIM_TOUCH(TMR1)
+#define TMR2 HOST_SIM_TOUCH(TMR2)
+#define TMR3 HOST_SIM_TOUCH(TMR3)
+#define TMR4 HOST_SIM_TOUCH(TMR4)
+#define TMR5 HOST_SIM_TOUCH(TMR5)
+#define TMR5HLD HOST_SIM_TOUCH(TMR5HLD)
+#endif
+
+#endif	/* HOST_XC_H */
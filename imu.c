@@ -0,0 +1,46 @@
+#include "imu.h"
+#include "spi.h"
+
+void accel_init(void) {
+    ACC_CS = 0;
+    spi_write(0x0F, 0x03); // +-2 g range
+    ACC_CS = 1;
+    ACC_CS = 0;
+    spi_write(0x10, 0x0B); // 62.5 Hz filter bandwidth
+    ACC_CS = 1;
+}
+
+int16_t merge_accel_bits(uint8_t low, uint8_t high) {
+    // 12 bit value, left aligned: the 4 LSBs of the low byte are not data
+    int16_t data = (int16_t)((high << 8) | (low & 0xF0));
+    return data / 16;
+}
+
+void accel_read(int16_t acc[3]) {
+    uint8_t readings[6];
+    ACC_CS = 0;
+    spi_read_multiple(readings, 0x02);
+    ACC_CS = 1;
+    for (int i = 0; i < 3; i++) {
+        acc[i] = merge_accel_bits(readings[2 * i], readings[2 * i + 1]);
+    }
+}
+
+void gyro_init(void) {
+    GYR_CS = 0;
+    spi_write(0x0F, 0x02); // +-500 dps range
+    GYR_CS = 1;
+    GYR_CS = 0;
+    spi_write(0x10, 0x07); // 100 Hz output data rate, 32 Hz filter bandwidth
+    GYR_CS = 1;
+}
+
+void gyro_read(int16_t gyro[3]) {
+    uint8_t readings[6];
+    GYR_CS = 0;
+    spi_read_multiple(readings, 0x02);
+    GYR_CS = 1;
+    for (int i = 0; i < 3; i++) {
+        gyro[i] = (int16_t)((readings[2 * i + 1] << 8) | readings[2 * i]);
+    }
+}
@@ -0,0 +1,36 @@
+/* 
+ * File:   imu.h
+ * Author: EMBG2
+ * Comments: BMX055 sensors on SPI1: accelerometer (CS1), gyroscope (CS2)
+ *           and magnetometer (CS3)
+ * Revision history: 
+ */
+
+#ifndef IMU_H
+#define	IMU_H
+
+#include <xc.h>
+#include <stdint.h>
+
+#define ACC_CS LATBbits.LATB3
+#define ACC_ONE_G 1024 // LSB per g in the +-2 g range
+#define GYR_CS LATBbits.LATB4
+#define MAG_CS LATDbits.LATD6
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+void accel_init(void);
+// reads x, y, z in LSB, ACC_ONE_G per g
+void accel_read(int16_t acc[3]);
+int16_t merge_accel_bits(uint8_t low, uint8_t high);
+void gyro_init(void);
+// reads x, y, z in LSB of the +-500 dps range (65.6 LSB per dps)
+void gyro_read(int16_t gyro[3]);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* IMU_H */
@@ -0,0 +1,36 @@
+#include "mag.h"
+#include <stdio.h>
+
+int16_t calculate_moving_average(int16_t new_value, int16_t buffer[MOVING_AVERAGE_SIZE], uint8_t *idx) {
+    buffer[*idx] = new_value;
+    if (++*idx == MOVING_AVERAGE_SIZE) { // a compare, no division
+        *idx = 0;
+    }
+    int16_t sum = 0;
+    for (uint8_t i = 0; i < MOVING_AVERAGE_SIZE; i++) {
+        sum += buffer[i];
+    }
+    return (int16_t)(sum / MOVING_AVERAGE_SIZE);
+}
+
+int16_t merge_significant_bits(uint8_t low, uint8_t high, int axis) {
+    int16_t data;
+    if (axis == 1 || axis == 2) {
+        uint8_t masked_low = low & 0xF8;
+        data = (int16_t)((high << 8) | masked_low);
+        data = data / 8;
+    } else {
+        uint8_t masked_low = low & 0xFE;
+        data = (int16_t)((high << 8) | masked_low);
+        data = data / 2;
+    }
+    return data;
+}
+
+int mag_format(char *buff, int16_t x, int16_t y, int16_t z) {
+    return sprintf(buff, "$MAG,%d,%d,%d*\n", x, y, z);
+}
+
+int mag_format_ts(char *buff, int16_t x, int16_t y, int16_t z, uint32_t t_us) {
+    return sprintf(buff, "$MAG,%d,%d,%d,%lu*\n", x, y, z, (unsigned long)t_us);
+}
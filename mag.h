@@ -0,0 +1,33 @@
+/* 
+ * File:   mag.h
+ * Author: EMBG2
+ * Comments: magnetometer sample conditioning and telemetry formatting
+ * Revision history: 
+ */
+
+#ifndef MAG_H
+#define	MAG_H
+
+#include <stdint.h>
+
+#define MOVING_AVERAGE_SIZE 5
+#define MAG_LINE_MAX 39 // "$MAG,-32768,-32768,-32768,4294967295*\n" and the terminator
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+int16_t calculate_moving_average(int16_t new_value, int16_t buffer[MOVING_AVERAGE_SIZE], uint8_t *idx);
+int16_t merge_significant_bits(uint8_t low, uint8_t high, int axis);
+
+// writes "$MAG,x,y,z*\n" into buff, returns the number of characters written
+int mag_format(char *buff, int16_t x, int16_t y, int16_t z);
+// same with the acquisition time appended: "$MAG,x,y,z,t_us*\n", the
+// longest of the two (MAG_LINE_MAX bytes)
+int mag_format_ts(char *buff, int16_t x, int16_t y, int16_t z, uint32_t t_us);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* MAG_H */
@@ -0,0 +1,84 @@
+#include "xc.h"
+#include "magacq.h"
+#include "imu.h"
+#include "spi.h"
+
+// mode 0 is the original free running 25 Hz setup with no decimation.
+// The others trigger a low repetition (about 3 ms) conversion every loop
+// and decimate it down to the telemetry rate
+const mag_acq_mode mag_acq_modes[MAGACQ_MODE_COUNT] = {
+    {0x30, 0x04, 0x0E, 0, 0, 25},
+    {0x06, 0x01, 0x02, 1, 1, 90}, // 90 Hz is one conversion per 11 ms loop
+    {0x06, 0x01, 0x02, 1, 2, 90},
+    {0x06, 0x01, 0x02, 1, 3, 90},
+};
+
+uint32_t magacq_cycles_max[MAGACQ_MODE_COUNT];
+
+static int current_mode = MAGACQ_DEFAULT_MODE;
+// CIC state, unsigned so that the integrators wrap without undefined behaviour
+static uint32_t integrator1[3];
+static uint32_t integrator2[3];
+static uint32_t comb1[3];
+static uint32_t comb2[3];
+static uint8_t phase = 0;
+
+static void mag_write(uint8_t reg, uint8_t value) {
+    MAG_CS = 0;
+    spi_write(reg, value);
+    MAG_CS = 1;
+}
+
+int magacq_set_mode(int mode) {
+    if (mode < 0 || mode >= MAGACQ_MODE_COUNT) {
+        return 0;
+    }
+    const mag_acq_mode *m = &mag_acq_modes[mode];
+    mag_write(0x51, m->rep_xy);
+    mag_write(0x52, m->rep_z);
+    mag_write(0x4C, m->control);
+    for (int i = 0; i < 3; i++) {
+        integrator1[i] = integrator2[i] = comb1[i] = comb2[i] = 0;
+    }
+    phase = 0;
+    current_mode = mode;
+    magacq_trigger();
+    return 1;
+}
+
+int magacq_mode(void) {
+    return current_mode;
+}
+
+void magacq_trigger(void) {
+    const mag_acq_mode *m = &mag_acq_modes[current_mode];
+    if (m->forced) {
+        mag_write(0x4C, (m->control & ~0x06) | 0x02); // opmode 01: forced, back to sleep when done
+    }
+}
+
+int magacq_push(const int16_t in[3], int16_t out[3]) {
+    uint8_t log2 = mag_acq_modes[current_mode].decimation_log2;
+    if (log2 == 0) {
+        out[0] = in[0];
+        out[1] = in[1];
+        out[2] = in[2];
+        return 1;
+    }
+    for (int i = 0; i < 3; i++) {
+        integrator1[i] += (uint32_t)(int32_t)in[i];
+        integrator2[i] += integrator1[i];
+    }
+    if (++phase < (1 << log2)) {
+        return 0;
+    }
+    phase = 0;
+    for (int i = 0; i < 3; i++) {
+        uint32_t stage1 = integrator2[i] - comb1[i];
+        comb1[i] = integrator2[i];
+        uint32_t stage2 = stage1 - comb2[i];
+        comb2[i] = stage1;
+        out[i] = (int16_t)((int32_t)stage2 >> (2 * log2)); // CIC gain is R^2
+    }
+    return 1;
+}
@@ -0,0 +1,48 @@
+/* 
+ * File:   magacq.h
+ * Author: EMBG2
+ * Comments: magnetometer acquisition modes. Each mode pairs a sensor
+ *           setting with a decimation factor: the sensor is sampled
+ *           once per main loop and a second order CIC filter decimates
+ *           the stream before the moving average and $MAG.
+ * Revision history: 
+ */
+
+#ifndef MAGACQ_H
+#define	MAGACQ_H
+
+#include <stdint.h>
+
+#define MAGACQ_MODE_COUNT 4
+#define MAGACQ_DEFAULT_MODE 0
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t control;    // register 0x4C: output data rate and operating mode
+    uint8_t rep_xy;     // register 0x51: x/y repetitions = 1 + 2 * rep_xy
+    uint8_t rep_z;      // register 0x52: z repetitions = 1 + rep_z
+    uint8_t forced;     // trigger a measurement every loop instead of free running
+    uint8_t decimation_log2;
+    uint8_t odr_hz;     // sensor samples per second reaching the filter
+} mag_acq_mode;
+
+extern const mag_acq_mode mag_acq_modes[MAGACQ_MODE_COUNT];
+// worst measured cost of magacq_push() per mode, instruction cycles
+extern uint32_t magacq_cycles_max[MAGACQ_MODE_COUNT];
+
+// configures the sensor, returns 0 for an unknown mode
+int magacq_set_mode(int mode);
+int magacq_mode(void);
+// starts the next measurement when the mode uses forced conversions
+void magacq_trigger(void);
+// feeds one sample, returns 1 when out holds a new decimated sample
+int magacq_push(const int16_t in[3], int16_t out[3]);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* MAGACQ_H */
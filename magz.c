@@ -0,0 +1,86 @@
+#include "magz.h"
+#include <stdio.h>
+
+volatile int magz_enabled = 0;
+
+static const char base64_chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void magz_init(magz_encoder *e) {
+    e->last[0] = e->last[1] = e->last[2] = 0;
+    e->len = 0;
+    e->samples = 0;
+    e->keyframe = 1;
+    e->seq = 0;
+    e->since_key = MAGZ_KEYFRAME_SAMPLES; // the first batch is a keyframe
+}
+
+void magz_resync(magz_encoder *e) {
+    e->since_key = MAGZ_KEYFRAME_SAMPLES;
+}
+
+// small differences of either sign map to small codes: 0, -1, 1, -2 -> 0, 1, 2, 3
+static uint16_t zigzag(int16_t v) {
+    return (uint16_t)(((uint16_t)v << 1) ^ (uint16_t)(v >> 15));
+}
+
+static void put_varint(magz_encoder *e, uint16_t v) {
+    while (v >= 0x80) {
+        e->payload[e->len++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    e->payload[e->len++] = (uint8_t)v;
+}
+
+int magz_flush(magz_encoder *e, char *line) {
+    if (e->samples == 0) {
+        return 0;
+    }
+    int n = sprintf(line, "$MZ,%u,%u,%u,", e->seq, e->keyframe, e->samples);
+    for (int i = 0; i < e->len; i += 3) {
+        uint32_t group = (uint32_t)e->payload[i] << 16;
+        int left = e->len - i;
+        if (left > 1) {
+            group |= (uint16_t)e->payload[i + 1] << 8;
+        }
+        if (left > 2) {
+            group |= e->payload[i + 2];
+        }
+        line[n++] = base64_chars[(group >> 18) & 0x3F];
+        line[n++] = base64_chars[(group >> 12) & 0x3F];
+        line[n++] = left > 1 ? base64_chars[(group >> 6) & 0x3F] : '=';
+        line[n++] = left > 2 ? base64_chars[group & 0x3F] : '=';
+    }
+    line[n++] = '*';
+    line[n++] = '\n';
+    line[n] = '\0';
+    e->seq++;
+    e->len = 0;
+    e->samples = 0;
+    return n;
+}
+
+int magz_push(magz_encoder *e, const int16_t v[3], char *line) {
+    if (e->samples == 0) {
+        e->keyframe = e->since_key >= MAGZ_KEYFRAME_SAMPLES;
+        if (e->keyframe) {
+            e->since_key = 0;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        if (e->samples == 0 && e->keyframe) {
+            put_varint(e, zigzag(v[i]));
+        } else {
+            put_varint(e, zigzag((int16_t)(v[i] - e->last[i]))); // wraps, the decoder wraps back
+        }
+        e->last[i] = v[i];
+    }
+    e->samples++;
+    if (e->since_key < MAGZ_KEYFRAME_SAMPLES) {
+        e->since_key++;
+    }
+    if (e->samples >= MAGZ_BATCH_SAMPLES || e->len > MAGZ_PAYLOAD_MAX - MAGZ_SAMPLE_MAX) {
+        return magz_flush(e, line);
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+/* 
+ * File:   magz.h
+ * Author: EMBG2
+ * Comments: compressed magnetometer telemetry. Every decimated sample is
+ *           sent as zig-zag varint deltas per axis, batched into one
+ *           base64 line; a batch starts from absolute values (keyframe)
+ *           at least every MAGZ_KEYFRAME_SAMPLES samples and after a line
+ *           could not be queued, so a decoder recovers from lost lines.
+ *
+ *           Line format:
+ *             "$MZ,<seq>,<keyframe>,<samples>,<base64 payload>*\n"
+ *           seq counts lines modulo 256. The payload holds samples x 3
+ *           varints (x, y, z): zig-zag values of the axis, or of the
+ *           16-bit wrapping difference to the previous sample when it is
+ *           not the first sample of a keyframe batch.
+ *           host/mzdecode.c decodes it.
+ * Revision history: 
+ */
+
+#ifndef MAGZ_H
+#define	MAGZ_H
+
+#include <stdint.h>
+
+#define MAGZ_PAYLOAD_MAX 36      // payload bytes per line, 48 base64 characters
+#define MAGZ_SAMPLE_MAX 9        // three varints of at most 3 bytes
+#define MAGZ_BATCH_SAMPLES 12    // latency bound, about 130 ms at the 11 ms loop
+#define MAGZ_KEYFRAME_SAMPLES 64
+#define MAGZ_LINE_MAX 64         // "$MZ,255,1,12," + 48 + "*\n" and the terminator
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int16_t last[3];
+    uint8_t payload[MAGZ_PAYLOAD_MAX];
+    uint8_t len;
+    uint8_t samples;
+    uint8_t keyframe;    // the current batch starts from absolute values
+    uint8_t seq;
+    uint16_t since_key;  // samples since the last keyframe
+} magz_encoder;
+
+extern volatile int magz_enabled; // $MZ,1* replaces $MAG by $MZ batches
+
+void magz_init(magz_encoder *e);
+// adds one sample, returns the length of a finished line written to line
+// (MAGZ_LINE_MAX bytes) or 0 while the batch is still filling
+int magz_push(magz_encoder *e, const int16_t v[3], char *line);
+// closes the batch early, same return value as magz_push
+int magz_flush(magz_encoder *e, char *line);
+// the next batch starts with a keyframe, call when a line was lost
+void magz_resync(magz_encoder *e);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* MAGZ_H */
@@ -51,17 +51,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=timer.c buffer.c uart.c spi.c newmainXC16.c parser.c
+SOURCEFILES_QUOTED_IF_SPACED=timer.c buffer.c uart.c spi.c newmainXC16.c parser.c mag.c command.c trace.c txq.c calib.c fixmath.c imu.c heading.c ahrs.c magacq.c event.c clock.c timesync.c capture.c stats.c prof.c route.c magz.c seqlock.c rategen.c shed.c dsp.c dspcost.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/timer.o ${OBJECTDIR}/buffer.o ${OBJECTDIR}/uart.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/newmainXC16.o ${OBJECTDIR}/parser.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/timer.o.d ${OBJECTDIR}/buffer.o.d ${OBJECTDIR}/uart.o.d ${OBJECTDIR}/spi.o.d ${OBJECTDIR}/newmainXC16.o.d ${OBJECTDIR}/parser.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/timer.o ${OBJECTDIR}/buffer.o ${OBJECTDIR}/uart.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/newmainXC16.o ${OBJECTDIR}/parser.o ${OBJECTDIR}/mag.o ${OBJECTDIR}/command.o ${OBJECTDIR}/trace.o ${OBJECTDIR}/txq.o ${OBJECTDIR}/calib.o ${OBJECTDIR}/fixmath.o ${OBJECTDIR}/imu.o ${OBJECTDIR}/heading.o ${OBJECTDIR}/ahrs.o ${OBJECTDIR}/magacq.o ${OBJECTDIR}/event.o ${OBJECTDIR}/clock.o ${OBJECTDIR}/timesync.o ${OBJECTDIR}/capture.o ${OBJECTDIR}/stats.o ${OBJECTDIR}/prof.o ${OBJECTDIR}/route.o ${OBJECTDIR}/magz.o ${OBJECTDIR}/seqlock.o ${OBJECTDIR}/rategen.o ${OBJECTDIR}/shed.o ${OBJECTDIR}/dsp.o ${OBJECTDIR}/dspcost.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/timer.o.d ${OBJECTDIR}/buffer.o.d ${OBJECTDIR}/uart.o.d ${OBJECTDIR}/spi.o.d ${OBJECTDIR}/newmainXC16.o.d ${OBJECTDIR}/parser.o.d ${OBJECTDIR}/mag.o.d ${OBJECTDIR}/command.o.d ${OBJECTDIR}/trace.o.d ${OBJECTDIR}/txq.o.d ${OBJECTDIR}/calib.o.d ${OBJECTDIR}/fixmath.o.d ${OBJECTDIR}/imu.o.d ${OBJECTDIR}/heading.o.d ${OBJECTDIR}/ahrs.o.d ${OBJECTDIR}/magacq.o.d ${OBJECTDIR}/event.o.d ${OBJECTDIR}/clock.o.d ${OBJECTDIR}/timesync.o.d ${OBJECTDIR}/capture.o.d ${OBJECTDIR}/stats.o.d ${OBJECTDIR}/prof.o.d ${OBJECTDIR}/route.o.d ${OBJECTDIR}/magz.o.d ${OBJECTDIR}/seqlock.o.d ${OBJECTDIR}/rategen.o.d ${OBJECTDIR}/shed.o.d ${OBJECTDIR}/dsp.o.d ${OBJECTDIR}/dspcost.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/timer.o ${OBJECTDIR}/buffer.o ${OBJECTDIR}/uart.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/newmainXC16.o ${OBJECTDIR}/parser.o
+OBJECTFILES=${OBJECTDIR}/timer.o ${OBJECTDIR}/buffer.o ${OBJECTDIR}/uart.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/newmainXC16.o ${OBJECTDIR}/parser.o ${OBJECTDIR}/mag.o ${OBJECTDIR}/command.o ${OBJECTDIR}/trace.o ${OBJECTDIR}/txq.o ${OBJECTDIR}/calib.o ${OBJECTDIR}/fixmath.o ${OBJECTDIR}/imu.o ${OBJECTDIR}/heading.o ${OBJECTDIR}/ahrs.o ${OBJECTDIR}/magacq.o ${OBJECTDIR}/event.o ${OBJECTDIR}/clock.o ${OBJECTDIR}/timesync.o ${OBJECTDIR}/capture.o ${OBJECTDIR}/stats.o ${OBJECTDIR}/prof.o ${OBJECTDIR}/route.o ${OBJECTDIR}/magz.o ${OBJECTDIR}/seqlock.o ${OBJECTDIR}/rategen.o ${OBJECTDIR}/shed.o ${OBJECTDIR}/dsp.o ${OBJECTDIR}/dspcost.o
 
 # Source Files
-SOURCEFILES=timer.c buffer.c uart.c spi.c newmainXC16.c parser.c
+SOURCEFILES=timer.c buffer.c uart.c spi.c newmainXC16.c parser.c mag.c command.c trace.c txq.c calib.c fixmath.c imu.c heading.c ahrs.c magacq.c event.c clock.c timesync.c capture.c stats.c prof.c route.c magz.c seqlock.c rategen.c shed.c dsp.c dspcost.c
 
 
 
@@ -125,6 +125,144 @@ ${OBJECTDIR}/parser.o: parser.c  .generated_files/flags/default/f0ac7f824a167495
 	@${RM} ${OBJECTDIR}/parser.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE)  parser.c  -o ${OBJECTDIR}/parser.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/parser.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
 	
+${OBJECTDIR}/mag.o: mag.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/mag.o.d 
+	@${RM} ${OBJECTDIR}/mag.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  mag.c  -o ${OBJECTDIR}/mag.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/mag.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/command.o: command.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/command.o.d 
+	@${RM} ${OBJECTDIR}/command.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  command.c  -o ${OBJECTDIR}/command.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/command.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/trace.o: trace.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/trace.o.d 
+	@${RM} ${OBJECTDIR}/trace.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  trace.c  -o ${OBJECTDIR}/trace.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/trace.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/txq.o: txq.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/txq.o.d 
+	@${RM} ${OBJECTDIR}/txq.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  txq.c  -o ${OBJECTDIR}/txq.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/txq.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/calib.o: calib.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/calib.o.d 
+	@${RM} ${OBJECTDIR}/calib.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  calib.c  -o ${OBJECTDIR}/calib.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/calib.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/fixmath.o: fixmath.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/fixmath.o.d 
+	@${RM} ${OBJECTDIR}/fixmath.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  fixmath.c  -o ${OBJECTDIR}/fixmath.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/fixmath.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/imu.o: imu.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/imu.o.d 
+	@${RM} ${OBJECTDIR}/imu.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  imu.c  -o ${OBJECTDIR}/imu.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/imu.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/heading.o: heading.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/heading.o.d 
+	@${RM} ${OBJECTDIR}/heading.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  heading.c  -o ${OBJECTDIR}/heading.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/heading.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/ahrs.o: ahrs.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/ahrs.o.d 
+	@${RM} ${OBJECTDIR}/ahrs.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ahrs.c  -o ${OBJECTDIR}/ahrs.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/ahrs.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/magacq.o: magacq.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/magacq.o.d 
+	@${RM} ${OBJECTDIR}/magacq.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  magacq.c  -o ${OBJECTDIR}/magacq.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/magacq.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/event.o: event.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/event.o.d 
+	@${RM} ${OBJECTDIR}/event.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  event.c  -o ${OBJECTDIR}/event.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/event.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/clock.o: clock.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/clock.o.d 
+	@${RM} ${OBJECTDIR}/clock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  clock.c  -o ${OBJECTDIR}/clock.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/clock.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/timesync.o: timesync.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/timesync.o.d 
+	@${RM} ${OBJECTDIR}/timesync.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  timesync.c  -o ${OBJECTDIR}/timesync.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/timesync.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/capture.o: capture.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/capture.o.d 
+	@${RM} ${OBJECTDIR}/capture.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  capture.c  -o ${OBJECTDIR}/capture.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/capture.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/stats.o: stats.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/stats.o.d 
+	@${RM} ${OBJECTDIR}/stats.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  stats.c  -o ${OBJECTDIR}/stats.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/stats.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/prof.o: prof.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/prof.o.d 
+	@${RM} ${OBJECTDIR}/prof.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  prof.c  -o ${OBJECTDIR}/prof.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/prof.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/route.o: route.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/route.o.d 
+	@${RM} ${OBJECTDIR}/route.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  route.c  -o ${OBJECTDIR}/route.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/route.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/magz.o: magz.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/magz.o.d 
+	@${RM} ${OBJECTDIR}/magz.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  magz.c  -o ${OBJECTDIR}/magz.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/magz.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/seqlock.o: seqlock.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/seqlock.o.d 
+	@${RM} ${OBJECTDIR}/seqlock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  seqlock.c  -o ${OBJECTDIR}/seqlock.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/seqlock.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/rategen.o: rategen.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/rategen.o.d 
+	@${RM} ${OBJECTDIR}/rategen.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  rategen.c  -o ${OBJECTDIR}/rategen.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/rategen.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/shed.o: shed.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/shed.o.d 
+	@${RM} ${OBJECTDIR}/shed.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  shed.c  -o ${OBJECTDIR}/shed.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/shed.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/dsp.o: dsp.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/dsp.o.d 
+	@${RM} ${OBJECTDIR}/dsp.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  dsp.c  -o ${OBJECTDIR}/dsp.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/dsp.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/dspcost.o: dspcost.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/dspcost.o.d 
+	@${RM} ${OBJECTDIR}/dspcost.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  dspcost.c  -o ${OBJECTDIR}/dspcost.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/dspcost.o.d"      -g -D__DEBUG   -mno-eds-warn  -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
 else
 ${OBJECTDIR}/timer.o: timer.c  .generated_files/flags/default/6dd8bc39c2f11f90677cd7b868d9eee8f7fe905a .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}" 
@@ -162,6 +300,144 @@ ${OBJECTDIR}/parser.o: parser.c  .generated_files/flags/default/17dffcbbaad33cf5
 	@${RM} ${OBJECTDIR}/parser.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE)  parser.c  -o ${OBJECTDIR}/parser.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/parser.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
 	
+${OBJECTDIR}/mag.o: mag.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/mag.o.d 
+	@${RM} ${OBJECTDIR}/mag.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  mag.c  -o ${OBJECTDIR}/mag.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/mag.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/command.o: command.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/command.o.d 
+	@${RM} ${OBJECTDIR}/command.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  command.c  -o ${OBJECTDIR}/command.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/command.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/trace.o: trace.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/trace.o.d 
+	@${RM} ${OBJECTDIR}/trace.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  trace.c  -o ${OBJECTDIR}/trace.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/trace.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/txq.o: txq.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/txq.o.d 
+	@${RM} ${OBJECTDIR}/txq.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  txq.c  -o ${OBJECTDIR}/txq.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/txq.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/calib.o: calib.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/calib.o.d 
+	@${RM} ${OBJECTDIR}/calib.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  calib.c  -o ${OBJECTDIR}/calib.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/calib.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/fixmath.o: fixmath.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/fixmath.o.d 
+	@${RM} ${OBJECTDIR}/fixmath.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  fixmath.c  -o ${OBJECTDIR}/fixmath.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/fixmath.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/imu.o: imu.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/imu.o.d 
+	@${RM} ${OBJECTDIR}/imu.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  imu.c  -o ${OBJECTDIR}/imu.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/imu.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/heading.o: heading.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/heading.o.d 
+	@${RM} ${OBJECTDIR}/heading.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  heading.c  -o ${OBJECTDIR}/heading.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/heading.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/ahrs.o: ahrs.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/ahrs.o.d 
+	@${RM} ${OBJECTDIR}/ahrs.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  ahrs.c  -o ${OBJECTDIR}/ahrs.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/ahrs.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/magacq.o: magacq.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/magacq.o.d 
+	@${RM} ${OBJECTDIR}/magacq.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  magacq.c  -o ${OBJECTDIR}/magacq.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/magacq.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/event.o: event.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/event.o.d 
+	@${RM} ${OBJECTDIR}/event.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  event.c  -o ${OBJECTDIR}/event.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/event.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/clock.o: clock.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/clock.o.d 
+	@${RM} ${OBJECTDIR}/clock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  clock.c  -o ${OBJECTDIR}/clock.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/clock.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/timesync.o: timesync.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/timesync.o.d 
+	@${RM} ${OBJECTDIR}/timesync.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  timesync.c  -o ${OBJECTDIR}/timesync.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/timesync.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/capture.o: capture.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/capture.o.d 
+	@${RM} ${OBJECTDIR}/capture.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  capture.c  -o ${OBJECTDIR}/capture.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/capture.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/stats.o: stats.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/stats.o.d 
+	@${RM} ${OBJECTDIR}/stats.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  stats.c  -o ${OBJECTDIR}/stats.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/stats.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/prof.o: prof.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/prof.o.d 
+	@${RM} ${OBJECTDIR}/prof.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  prof.c  -o ${OBJECTDIR}/prof.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/prof.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/route.o: route.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/route.o.d 
+	@${RM} ${OBJECTDIR}/route.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  route.c  -o ${OBJECTDIR}/route.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/route.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/magz.o: magz.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/magz.o.d 
+	@${RM} ${OBJECTDIR}/magz.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  magz.c  -o ${OBJECTDIR}/magz.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/magz.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/seqlock.o: seqlock.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/seqlock.o.d 
+	@${RM} ${OBJECTDIR}/seqlock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  seqlock.c  -o ${OBJECTDIR}/seqlock.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/seqlock.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/rategen.o: rategen.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/rategen.o.d 
+	@${RM} ${OBJECTDIR}/rategen.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  rategen.c  -o ${OBJECTDIR}/rategen.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/rategen.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/shed.o: shed.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/shed.o.d 
+	@${RM} ${OBJECTDIR}/shed.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  shed.c  -o ${OBJECTDIR}/shed.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/shed.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/dsp.o: dsp.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/dsp.o.d 
+	@${RM} ${OBJECTDIR}/dsp.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  dsp.c  -o ${OBJECTDIR}/dsp.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/dsp.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
+${OBJECTDIR}/dspcost.o: dspcost.c  .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/dspcost.o.d 
+	@${RM} ${OBJECTDIR}/dspcost.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE)  dspcost.c  -o ${OBJECTDIR}/dspcost.o  -c -mcpu=$(MP_PROCESSOR_OPTION)  -MP -MMD -MF "${OBJECTDIR}/dspcost.o.d"      -mno-eds-warn  -g -omf=elf -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -O0 -msmart-io=1 -Wall -msfr-warn=off   
+	
 endif
 
 # ------------------------------------------------------------------------------------
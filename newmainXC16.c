@@ -4,29 +4,60 @@
 #include "spi.h"
 #include "parser.h"
 #include "buffer.h"
+#include "mag.h"
+#include "command.h"
+#include "trace.h"
+#include "txq.h"
+#include "calib.h"
+#include "imu.h"
+#include "heading.h"
+#include "fixmath.h"
+#include "ahrs.h"
+#include "magacq.h"
+#include "event.h"
+#include "clock.h"
+#include "timesync.h"
+#include "capture.h"
+#include "prof.h"
+#include "route.h"
+#include "magz.h"
+#include "seqlock.h"
+#include "rategen.h"
+#include "shed.h"
+#include "dsp.h"
 #include <stdio.h>
-#include <string.h>
-#include <math.h>
 
-#define MAG_CS LATDbits.LATD6
 #define NUM_READINGS 6
-#define MOVING_AVERAGE_SIZE 5
-
-int ret;
-char *patterns[] = {};
-char buff[35];
-int16_t moving_average_buffer_x[MOVING_AVERAGE_SIZE];
-int16_t moving_average_buffer_y[MOVING_AVERAGE_SIZE];
-int16_t moving_average_buffer_z[MOVING_AVERAGE_SIZE];
-uint8_t buffer_x_index = 0;
-uint8_t buffer_y_index = 0;
-uint8_t buffer_z_index = 0;
+#define LOOP_PERIOD_MS 11
+#define AVERAGE_TAP (DSP_Q15_ONE / MOVING_AVERAGE_SIZE) // Q15, every tap the same
+
+char buff[MAG_LINE_MAX]; // $YAW, $ATT and $SHED lines are shorter
+// moving average of the decimated samples, an FIR with equal taps
+DSP_COEFFS(average_taps, MOVING_AVERAGE_SIZE);
+DSP_DELAY_LINE(average_delay_x, MOVING_AVERAGE_SIZE);
+DSP_DELAY_LINE(average_delay_y, MOVING_AVERAGE_SIZE);
+DSP_DELAY_LINE(average_delay_z, MOVING_AVERAGE_SIZE);
+dsp_fir average_fir[3];
 uint8_t readings[NUM_READINGS];
+int16_t acc_filtered[3];
+int16_t heading = 0; // binary angle, updated every sample
+uint32_t mag_sample_us = 0; // now_us() when the last magnetometer sample was read
+magz_encoder magz;
+// newest averaged sample for the telemetry, safe to read even once acquisition runs in an interrupt
+seqlock_triple mag_snapshot;
+rate_gen yaw_rate; // $YAW and $ATT
+rate_gen led_rate;
+char mz_line[MAGZ_LINE_MAX];
+
+typedef struct {
+    uint16_t t3, t2;
+} stopwatch;
 
-parser_state ps;
-volatile int mag_rate_hz = 5; // default 5 Hz
-int16_t calculate_moving_average(int16_t new_value, int16_t buffer[MOVING_AVERAGE_SIZE], uint8_t *idx);
-int16_t merge_significant_bits(uint8_t low, uint8_t high, int axis);
+void control_step(void);
+uint16_t loop_slack_permille(void);
+void stopwatch_start(stopwatch *sw);
+uint32_t stopwatch_cycles(const stopwatch *sw);
+void handle_commands(unsigned char uart);
 void simulate_algorithm(void);
 void update_led(void);
 
@@ -37,16 +68,34 @@ int main(void) {
     TRISAbits.TRISA0 = 0; 
     TRISGbits.TRISG9 = 0;
 
-    buffer_init(&main_buffer_1, patterns, 0);
-    buffer_init(&transmit_buffer1, patterns, 0);
-    buffer_init(&transmit_buffer2, patterns, 0);
+    dsp_init();
+    for (int i = 0; i < MOVING_AVERAGE_SIZE; i++) {
+        average_taps[i] = AVERAGE_TAP;
+    }
+    dsp_fir_init(&average_fir[0], average_taps, average_delay_x, MOVING_AVERAGE_SIZE);
+    dsp_fir_init(&average_fir[1], average_taps, average_delay_y, MOVING_AVERAGE_SIZE);
+    dsp_fir_init(&average_fir[2], average_taps, average_delay_z, MOVING_AVERAGE_SIZE);
+    buffer_init(&main_buffer_1);
+    buffer_init(&main_buffer_2);
+    buffer_init(&transmit_buffer1);
+    buffer_init(&transmit_buffer2);
 
-    // Init parser
-    ps.state = STATE_DOLLAR;
-    ps.index_type = 0; 
-    ps.index_payload = 0;
+    // Init parser, after the rate generators it sets up
+    rategen_init(LOOP_PERIOD_MS);
+    rategen_set(&yaw_rate, 5000); // 5 Hz
+    rategen_set(&led_rate, 2000); // toggled every 500 ms
+    command_init();
+    event_init();
+    calib_init();
+    shed_init();
+    magz_init(&magz);
+    seqlock_init(&mag_snapshot);
+    clock_init();
+    prof_init();
+    timesync_init();
 
     UART_Init(UART_1);
+    UART_Init(UART_2);
 
     spi_init();
     tmr_wait_ms(TIMER1, 5);
@@ -56,103 +105,238 @@ int main(void) {
     MAG_CS = 1;
     tmr_wait_ms(TIMER1, 5);
 
-    MAG_CS = 0;
-    spi_write(0x4C, 0x30);
-    MAG_CS = 1;
+    magacq_set_mode(MAGACQ_DEFAULT_MODE);
     tmr_wait_ms(TIMER1, 5);
 
     MAG_CS = 0;
     uint8_t chip_id = spi_read(0x40);
     MAG_CS = 1;
 
+    accel_init();
+    gyro_init();
+    accel_read(acc_filtered);
+
     send_uart_char(UART_1, chip_id / 16 + '0');
     send_uart_char(UART_1, chip_id % 16 + '0');
     send_uart_char(UART_1, '\n');
 
-    static int mag_send_timer = 0;
-    static int yaw_send_timer = 0;
-    static int led_timer = 0;
+    // start the orientation filter from the first accelerometer / magnetometer reading
+    MAG_CS = 0;
+    spi_read_multiple(readings, 0x42);
+    MAG_CS = 1;
+    int16_t first_mag[3] = {
+        merge_significant_bits(readings[0], readings[1], 1),
+        merge_significant_bits(readings[2], readings[3], 2),
+        merge_significant_bits(readings[4], readings[5], 3)
+    };
+    ahrs_init(LOOP_PERIOD_MS, acc_filtered, first_mag);
 
-    tmr_setup_period(TIMER2, 11);
-    tmr_turn(TIMER2, 1); 
+    event_tick_start(LOOP_PERIOD_MS);
 
     while(1){
-        simulate_algorithm();
-
-        // Read Magnetometer from SPI
-        MAG_CS = 0;
-        spi_read_multiple(readings, 0x42);
-        MAG_CS = 1;
-        int16_t x_data = merge_significant_bits(readings[0], readings[1], 1);
-        int16_t average_x = calculate_moving_average(x_data, moving_average_buffer_x, &buffer_x_index);
-        int16_t y_data = merge_significant_bits(readings[2], readings[3], 2);
-        int16_t average_y = calculate_moving_average(y_data, moving_average_buffer_y, &buffer_y_index);
-        int16_t z_data = merge_significant_bits(readings[4], readings[5], 3);
-        int16_t average_z = calculate_moving_average(z_data, moving_average_buffer_z, &buffer_z_index);
-
-        mag_send_timer += 10;
-        yaw_send_timer += 10;
-        led_timer += 10;
-
-        if (mag_rate_hz != 0) {
-            if (mag_send_timer >= (1000 / mag_rate_hz)) {
-                mag_send_timer = 0;
-                sprintf(buff, "$MAG,%d,%d,%d*\n", average_x, average_y, average_z);
-                send_uart_string(UART_1, buff);
+        // commands first: a frame is handled as soon as its '*' arrives
+        switch (event_get()) {
+            case EVENT_RX_FRAME_1:
+                handle_commands(UART_1);
+                break;
+            case EVENT_RX_FRAME_2:
+                handle_commands(UART_2);
+                break;
+            case EVENT_TICK:
+                control_step();
+                // bytes without a closing '*' yet, as before
+                handle_commands(UART_1);
+                handle_commands(UART_2);
+                // another tick already queued means this step overran its period
+                {
+                    uint16_t slack = loop_slack_permille();
+                    int overrun = event_pending(EVENT_LANE_TIMER2);
+                    LATAbits.LATA0 = overrun;
+                    if (shed_update(overrun ? 0 : slack)) {
+                        shed_format_level(buff);
+                        txq_send(UART_1, TXQ_PRIO_HIGH, buff);
+                    }
+                }
+                break;
+            default:
+                event_idle();
+                break;
+        }
+    }
+}
+
+// one period of the control loop, run on every EVENT_TICK
+void control_step(void) {
+    static int16_t average_x = 0, average_y = 0, average_z = 0; // kept between decimated outputs
+
+    simulate_algorithm();
+
+    // Read Magnetometer from SPI
+    MAG_CS = 0;
+    spi_read_multiple(readings, 0x42);
+    MAG_CS = 1;
+    mag_sample_us = now_us();
+    capture_sample(mag_sample_us, readings);
+    int16_t raw[3], mag[3];
+    raw[0] = merge_significant_bits(readings[0], readings[1], 1);
+    raw[1] = merge_significant_bits(readings[2], readings[3], 2);
+    raw[2] = merge_significant_bits(readings[4], readings[5], 3);
+    if (calib_running()) {
+        calib_update(raw);
+    }
+    calib_apply(&mag_cal, raw, mag);
+    magacq_trigger();
+
+    // decimation, cost in instruction cycles
+    int16_t decimated[3];
+    stopwatch sw;
+    stopwatch_start(&sw);
+    int acq_ready = magacq_push(mag, decimated);
+    uint32_t acq_cycles = stopwatch_cycles(&sw);
+    if (acq_cycles > magacq_cycles_max[magacq_mode()]) {
+        magacq_cycles_max[magacq_mode()] = acq_cycles;
+    }
+    if (acq_ready) {
+        average_x = dsp_fir_mod_q15(&average_fir[0], decimated[0]);
+        average_y = dsp_fir_mod_q15(&average_fir[1], decimated[1]);
+        average_z = dsp_fir_mod_q15(&average_fir[2], decimated[2]);
+        int16_t sample[3] = {average_x, average_y, average_z};
+        seqlock_write(&mag_snapshot, sample, mag_sample_us);
+        if (magz_enabled) {
+            // every decimated sample, batched; $RATE does not apply
+            if (magz_push(&magz, sample, mz_line) > 0) {
+                for (unsigned char uart = UART_1; uart <= UART_2; uart++) {
+                    if (route_has(ROUTE_MAG, uart) && !txq_send(uart, TXQ_PRIO_NORMAL, mz_line)) {
+                        magz_resync(&magz); // the next batch must not depend on the lost one
+                    }
+                }
             }
+        } else {
+            magz_init(&magz); // $MZ,1* starts over with a keyframe
         }
+    }
 
-        if (yaw_send_timer >= 200) {
-            yaw_send_timer = 0;
-            int heading_deg = atan2(average_y, average_x) * (180.0 / M_PI);
-            sprintf(buff, "$YAW,%d*\n", heading_deg);
-            send_uart_string(UART_1, buff);
+    // tilt compensated heading at the full sample rate
+    int16_t acc[3];
+    accel_read(acc);
+    for (int i = 0; i < 3; i++) {
+        acc_filtered[i] += (acc[i] - acc_filtered[i]) / 4;
+    }
+    if (!shed_skip(SHED_HEADING)) {
+        int16_t average_mag[3] = {average_x, average_y, average_z};
+        stopwatch_start(&sw);
+        heading = tilt_heading(average_mag, acc_filtered);
+        uint32_t cycles = stopwatch_cycles(&sw);
+        if (cycles > 0) {
+            heading_cycles_last = cycles;
+            if (heading_cycles_last > heading_cycles_max) {
+                heading_cycles_max = heading_cycles_last;
+            }
         }
+    }
 
-        if (led_timer >= 500){
-            led_timer = 0;
-            update_led();
+    // full orientation, cost in instruction cycles; under load the gyro is not read either
+    if (!shed_skip(SHED_AHRS)) {
+        int16_t gyro[3];
+        gyro_read(gyro);
+        stopwatch_start(&sw);
+        ahrs_update(gyro, acc, mag);
+        uint32_t cycles = stopwatch_cycles(&sw);
+        if (cycles > 0) {
+            ahrs_cycles_last = cycles;
+            if (ahrs_cycles_last > ahrs_cycles_max) {
+                ahrs_cycles_max = ahrs_cycles_last;
+            }
         }
+    }
+
+    // telemetry from the snapshot, host time once a $SYNC exchange has completed, board time before
+    int16_t m[3];
+    uint32_t m_us;
+    seqlock_read(&mag_snapshot, m, &m_us);
+    uint32_t stamp_us = timesync_valid() ? timesync_to_host(m_us) : m_us;
 
-        IEC0bits.U1RXIE = 0;
-        process_uart();
-        IEC0bits.U1RXIE = 1;
+    int mag_formatted = 0;
+    for (unsigned char uart = UART_1; uart <= UART_2; uart++) {
+        // every generator advances each period, even while its stream is off
+        if (rategen_fire(&mag_rate[UART_INDEX(uart)]) && !magz_enabled && route_has(ROUTE_MAG, uart)
+            && !shed_skip(SHED_MAG)) {
+            if (!mag_formatted) {
+                if (timestamps_enabled) {
+                    mag_format_ts(buff, m[0], m[1], m[2], stamp_us);
+                } else {
+                    mag_format(buff, m[0], m[1], m[2]);
+                }
+                mag_formatted = 1;
+            }
+            txq_send(uart, TXQ_PRIO_BULK, buff);
+        }
+    }
 
-        if (transmit_buffer1.count > 0){
-            IEC0bits.U1TXIE = 1;
+    if (rategen_fire(&yaw_rate)) {
+        if (timestamps_enabled) {
+            sprintf(buff, "$YAW,%d,%lu*\n", fx_angle_to_deg(heading), (unsigned long)stamp_us);
+        } else {
+            sprintf(buff, "$YAW,%d*\n", fx_angle_to_deg(heading));
         }
+        route_send(ROUTE_YAW, TXQ_PRIO_HIGH, buff);
 
-        ret = tmr_wait_period_3(TIMER2);
-        if (ret){
-            LATAbits.LATA0 = 1;
-        } else{
-            LATAbits.LATA0 = 0;
+        // roll, pitch and heading in degrees, heading with the same sign as $YAW
+        if (!shed_skip(SHED_ATT)) {
+            int16_t roll, pitch, yaw;
+            ahrs_euler(&roll, &pitch, &yaw);
+            sprintf(buff, "$ATT,%d,%d,%d*\n", fx_angle_to_deg(roll), fx_angle_to_deg(pitch), fx_angle_to_deg(-yaw));
+            route_send(ROUTE_ATT, TXQ_PRIO_NORMAL, buff);
         }
     }
+
+    if (rategen_fire(&led_rate)){
+        update_led();
+    }
+    rategen_advance();
 }
 
-int16_t calculate_moving_average(int16_t new_value, int16_t buffer[MOVING_AVERAGE_SIZE], uint8_t *idx) {
-    buffer[*idx] = new_value;
-    *idx = (*idx + 1) % MOVING_AVERAGE_SIZE;
-    int16_t sum = 0;
-    for (uint8_t i = 0; i < MOVING_AVERAGE_SIZE; i++) {
-        sum += buffer[i];
+void handle_commands(unsigned char uart) {
+    uart_rx_interrupt_enable(uart, 0);
+    process_uart(uart);
+    uart_rx_interrupt_enable(uart, 1);
+
+    if (transmit_buffer1.count > 0 || txq_pending(UART_1) || capture_dumping() || trace_dumping()){
+        uart_tx_interrupt_enable(UART_1, 1);
+    }
+    if (transmit_buffer2.count > 0 || txq_pending(UART_2)){
+        uart_tx_interrupt_enable(UART_2, 1);
     }
-    return (int16_t)(sum / MOVING_AVERAGE_SIZE);
 }
 
-int16_t merge_significant_bits(uint8_t low, uint8_t high, int axis) {
-    int16_t data;
-    if (axis == 1 || axis == 2) {
-        uint8_t masked_low = low & 0xF8;
-        data = (int16_t)((high << 8) | masked_low);
-        data = data / 8;
-    } else {
-        uint8_t masked_low = low & 0xFE;
-        data = (int16_t)((high << 8) | masked_low);
-        data = data / 2;
-    }
-    return data;
+// Timer3 counts every instruction cycle but wraps after 65535 (0.9 ms), the
+// loop timer (TMR2, FCY / 64) takes over for longer spans
+void stopwatch_start(stopwatch *sw) {
+    sw->t2 = TMR2;
+    sw->t3 = TMR3;
+}
+
+// cycles since stopwatch_start, 0 when the loop period restarted in between
+uint32_t stopwatch_cycles(const stopwatch *sw) {
+    uint16_t t3 = TMR3;
+    uint16_t t2 = TMR2;
+    if (t2 < sw->t2) {
+        return 0;
+    }
+    if (t2 - sw->t2 >= 1000) {
+        return (uint32_t)(t2 - sw->t2) * 64;
+    }
+    return (uint16_t)(t3 - sw->t3);
+}
+
+// part of the control period still left, read before checking for a pending tick
+uint16_t loop_slack_permille(void) {
+    uint16_t elapsed = TMR2;
+    uint16_t period = PR2;
+    if (elapsed >= period) {
+        return 0;
+    }
+    return (uint16_t)((uint32_t)(period - elapsed) * 1000 / ((uint32_t)period + 1));
 }
 
 void simulate_algorithm(void) {
@@ -162,23 +346,3 @@ void simulate_algorithm(void) {
 void update_led(void) {
     LATGbits.LATG9 ^= 1;
 }
-
-void process_uart(void) {
-    char c;
-    while (buffer_read(&main_buffer_1, &c)) {
-        if (parse_byte(&ps, c) == NEW_MESSAGE) {
-            sprintf(buff, "$MSG,%s,%s*\n", ps.msg_type, ps.msg_payload);
-            send_uart_string(UART_1, buff);
-            if (strcmp(ps.msg_type, "RATE") == 0) {
-                int new_rate = extract_integer(ps.msg_payload);
-                if (new_rate == 0 || new_rate == 1 || new_rate == 2 || new_rate == 4 || new_rate == 5 || new_rate == 10) {
-                    sprintf(buff, "$NEW_RATE,%d*\n", new_rate);
-                    send_uart_string(UART_1, buff);
-                    mag_rate_hz = new_rate;
-                } else {
-                    send_uart_string(UART_1, "$ERR,1*\n");
-                }
-            }
-        }
-    }
-}
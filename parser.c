@@ -1,4 +1,14 @@
 #include "parser.h"
+#include <string.h>
+
+// the message is in the _buf arrays
+static int buffered_message(parser_state* ps) {
+    ps->msg_type = ps->msg_type_buf;
+    ps->msg_payload = ps->msg_payload_buf;
+    ps->type_len = ps->index_type;
+    ps->payload_len = ps->index_payload;
+    return NEW_MESSAGE;
+}
 
 int parse_byte(parser_state* ps, char byte) {
     switch (ps->state) {
@@ -11,31 +21,34 @@ int parse_byte(parser_state* ps, char byte) {
         case STATE_TYPE:
             if (byte == ',') {
                 ps->state = STATE_PAYLOAD;
-                ps->msg_type[ps->index_type] = '\0';
+                ps->msg_type_buf[ps->index_type] = '\0';
                 ps->index_payload = 0; // initialize properly the index
-            } else if (ps->index_type == 6) { // error! 
+            } else if (ps->index_type == MSG_TYPE_MAX) { // error! 
                 ps->state = STATE_DOLLAR;
                 ps->index_type = 0;
-			} else if (byte == '*') {
-				ps->state = STATE_DOLLAR; // get ready for a new message
-                ps->msg_type[ps->index_type] = '\0';
-				ps->msg_payload[0] = '\0'; // no payload
-                return NEW_MESSAGE;
+                ps->resets++;
+            } else if (byte == '*') {
+                ps->state = STATE_DOLLAR; // get ready for a new message
+                ps->msg_type_buf[ps->index_type] = '\0';
+                ps->msg_payload_buf[0] = '\0'; // no payload
+                ps->index_payload = 0;
+                return buffered_message(ps);
             } else {
-                ps->msg_type[ps->index_type] = byte; // ok!
+                ps->msg_type_buf[ps->index_type] = byte; // ok!
                 ps->index_type++; // increment for the next time;
             }
             break;
         case STATE_PAYLOAD:
             if (byte == '*') {
                 ps->state = STATE_DOLLAR; // get ready for a new message
-                ps->msg_payload[ps->index_payload] = '\0';
-                return NEW_MESSAGE;
-            } else if (ps->index_payload == 100) { // error
+                ps->msg_payload_buf[ps->index_payload] = '\0';
+                return buffered_message(ps);
+            } else if (ps->index_payload == MSG_PAYLOAD_MAX) { // error
                 ps->state = STATE_DOLLAR;
                 ps->index_payload = 0;
+                ps->resets++;
             } else {
-                ps->msg_payload[ps->index_payload] = byte; // ok!
+                ps->msg_payload_buf[ps->index_payload] = byte; // ok!
                 ps->index_payload++; // increment for the next time;
             }
             break;
@@ -43,6 +56,73 @@ int parse_byte(parser_state* ps, char byte) {
     return NO_MESSAGE;
 }
 
+int parse_bytes(parser_state* ps, const char* span, int len, int* used) {
+    int i = 0;
+    ps->frame_start = -1;
+    while (i < len) {
+        if (ps->state == STATE_DOLLAR) {
+            const char *dollar = memchr(span + i, '$', len - i);
+            if (dollar == NULL) {
+                i = len; // noise
+                break;
+            }
+            i = dollar - span;
+            ps->frame_start = i++;
+            ps->state = STATE_TYPE;
+            ps->index_type = 0;
+        } else if (ps->state == STATE_TYPE) {
+            // a few bytes at most, the same checks as parse_byte
+            char byte = span[i++];
+            if (byte == ',') {
+                ps->state = STATE_PAYLOAD;
+                ps->msg_type_buf[ps->index_type] = '\0';
+                ps->index_payload = 0;
+            } else if (ps->index_type == MSG_TYPE_MAX) {
+                ps->state = STATE_DOLLAR;
+                ps->index_type = 0;
+                ps->resets++;
+                ps->frame_start = -1;
+            } else if (byte == '*') {
+                ps->state = STATE_DOLLAR;
+                ps->msg_type_buf[ps->index_type] = '\0';
+                ps->msg_payload_buf[0] = '\0'; // no payload
+                ps->index_payload = 0;
+                *used = i;
+                return buffered_message(ps);
+            } else {
+                ps->msg_type_buf[ps->index_type] = byte;
+                ps->index_type++;
+            }
+        } else {
+            // the byte after a full payload must be the '*'
+            int room = MSG_PAYLOAD_MAX - ps->index_payload;
+            int n = len - i;
+            const char *star = memchr(span + i, '*', (n <= room) ? n : room + 1);
+            if (star != NULL) {
+                n = star - (span + i);
+            } else if (n > room) {
+                ps->state = STATE_DOLLAR;
+                ps->index_payload = 0;
+                ps->resets++;
+                ps->frame_start = -1;
+                i += room + 1;
+                continue;
+            }
+            memcpy(ps->msg_payload_buf + ps->index_payload, span + i, n);
+            ps->index_payload += n;
+            i += n;
+            if (star != NULL) {
+                ps->state = STATE_DOLLAR;
+                ps->msg_payload_buf[ps->index_payload] = '\0';
+                *used = i + 1;
+                return buffered_message(ps);
+            }
+        }
+    }
+    *used = i;
+    return NO_MESSAGE;
+}
+
 int extract_integer(const char* str) {
 	int i = 0, number = 0, sign = 1;
 	
@@ -62,6 +142,45 @@ int extract_integer(const char* str) {
 	return sign*number;
 }		
 
+unsigned long extract_ulong(const char* str) {
+	int i = 0;
+	unsigned long number = 0;
+
+	while (str[i] >= '0' && str[i] <= '9') {
+		number = number * 10 + (str[i] - '0');
+		i++;
+	}
+	return number;
+}
+
+long extract_millis(const char* str) {
+	int i = 0, decimals = -1;
+	long number = 0;
+
+	for (; str[i] != ',' && str[i] != '\0'; i++) {
+		if (str[i] == '.' && decimals < 0 && i > 0) {
+			decimals = 0;
+		} else if (str[i] >= '0' && str[i] <= '9' && decimals < 3 && number < 100000000L) {
+			number = number * 10 + (str[i] - '0');
+			if (decimals >= 0) {
+				decimals++;
+			}
+		} else {
+			return -1;
+		}
+	}
+	if (i == 0 || decimals == 0) {
+		return -1; // empty or "5."
+	}
+	if (decimals < 0) {
+		decimals = 0;
+	}
+	for (; decimals < 3; decimals++) {
+		number *= 10;
+	}
+	return number;
+}
+
 int next_value(const char* msg, int i) {
     while (msg[i] != ',' && msg[i] != '\0') { 
         i++; 
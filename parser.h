@@ -7,12 +7,22 @@
 #define NEW_MESSAGE (1) // new message received and parsed completely
 #define NO_MESSAGE (0) // no new messages
 
+#define MSG_TYPE_MAX 6 // longest type, when followed by a ','
+#define MSG_PAYLOAD_MAX 100
+
 typedef struct { 
 	int state;
-	char msg_type[6]; // type is 5 chars + string terminator
-	char msg_payload[100];  // assume payload cannot be longer than 100 chars
+	char msg_type_buf[MSG_TYPE_MAX + 1]; // copies of a message that did not arrive in one span
+	char msg_payload_buf[MSG_PAYLOAD_MAX + 1];
 	int index_type;
 	int index_payload;
+	unsigned int resets; // messages discarded because type or payload were too long
+	// the message just parsed, '\0' terminated strings
+	char *msg_type;
+	char *msg_payload;
+	int type_len;
+	int payload_len;
+	int frame_start; // parse_bytes: offset in the span of the '$' of the current frame, -1 if not in it
 } parser_state;
 
 /*
@@ -23,6 +33,18 @@ Parsing another byte will override the contents of those arrays.
 */
 int parse_byte(parser_state* ps, char byte);
 
+/*
+Same parser over a contiguous span of bytes, e.g. straight from an RX ring
+(buffer_span). Stops right after the first complete message and stores the
+number of bytes used in *used; returns NEW_MESSAGE or NO_MESSAGE like
+parse_byte. Noise is skipped with memchr and the payload is found with a
+scan and copied with memcpy, so the cost follows the messages more than
+the bytes. The span is only read: the RX interrupt and the receive stamps
+(timesync_rx_span) still use it. The message is copied into the _buf
+arrays, and the strings stay valid until the next call.
+*/
+int parse_bytes(parser_state* ps, const char* span, int len, int* used);
+
 /*
 Takes a string as input, and converts it to an integer. Stops parsing when reaching
 the end of string or a ","
@@ -30,6 +52,17 @@ the result is undefined if a wrong string is passed
 */
 int extract_integer(const char* str);
 
+/*
+Same as extract_integer for unsigned values that need 32 bits, like timestamps
+*/
+unsigned long extract_ulong(const char* str);
+
+/*
+Decimal value with up to three decimals, like "0.5" or "12.125", in thousandths.
+Stops at the end of string or a ","; returns -1 for anything else, including signs
+*/
+long extract_millis(const char* str);
+
 /*
 The function takes a string, and an index within the string, and returns the index where the next data can be found
 Example: with the string "10,20,30", and i=0 it will return 3. With the same string and i=3, it will return 6.
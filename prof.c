@@ -0,0 +1,37 @@
+#include "xc.h"
+#include "prof.h"
+#include <stdio.h>
+
+volatile prof_isr prof[PROF_ISR_COUNT];
+
+void prof_init(void) {
+    T3CONbits.TON = 0;
+    T3CONbits.TCKPS = 0; // 1:1, one tick per instruction cycle
+    TMR3 = 0;
+    PR3 = 0xFFFF;        // free running over the whole 16 bits
+    T3CONbits.TON = 1;
+#if PROF_GPIO_ENABLE
+    TRISEbits.TRISE0 = 0;
+    TRISEbits.TRISE1 = 0;
+    TRISEbits.TRISE2 = 0;
+    TRISEbits.TRISE3 = 0;
+    TRISEbits.TRISE4 = 0;
+    TRISEbits.TRISE5 = 0;
+#endif
+    prof_reset();
+}
+
+void prof_reset(void) {
+    for (int i = 0; i < PROF_ISR_COUNT; i++) {
+        prof[i].count = 0;
+        prof[i].total = 0;
+        prof[i].max = 0;
+        prof[i].latency_max = 0;
+    }
+}
+
+void prof_format(char *reply, int id) {
+    volatile prof_isr *p = &prof[id];
+    unsigned long mean = p->count ? p->total / p->count : 0;
+    sprintf(reply, "$PROF,%d,%u,%lu,%u,%u*\n", id, p->count, mean, p->max, p->latency_max);
+}
@@ -0,0 +1,95 @@
+/* 
+ * File:   prof.h
+ * Author: EMBG2
+ * Comments: interrupt profiling. PROF_ISR_ENTER / PROF_ISR_EXIT read
+ *           Timer3, free running at FCY, so durations are in instruction
+ *           cycles (up to 65535, about 0.9 ms). Timer interrupts also get
+ *           their entry latency: their own counter restarted from zero
+ *           when the flag was raised. With PROF_GPIO_ENABLE each profiled
+ *           interrupt drives a pin high while it runs.
+ * Revision history: 
+ */
+
+#ifndef PROF_H
+#define	PROF_H
+
+#include <xc.h>
+#include <stdint.h>
+
+#define PROF_ENABLE 1
+#define PROF_GPIO_ENABLE 0
+
+#define PROF_U1RX 0
+#define PROF_U1TX 1
+#define PROF_U2RX 2
+#define PROF_U2TX 3
+#define PROF_T2 4
+#define PROF_T5 5
+#define PROF_ISR_COUNT 6
+
+// logic analyser pins, only driven with PROF_GPIO_ENABLE
+#define PROF_PIN_U1RX LATEbits.LATE0
+#define PROF_PIN_U1TX LATEbits.LATE1
+#define PROF_PIN_U2RX LATEbits.LATE2
+#define PROF_PIN_U2TX LATEbits.LATE3
+#define PROF_PIN_T2 LATEbits.LATE4
+#define PROF_PIN_T5 LATEbits.LATE5
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    unsigned int count;
+    uint32_t total;           // cycles
+    unsigned int max;         // cycles
+    unsigned int latency_max; // cycles from the flag to the first instruction, timers only
+} prof_isr;
+
+extern volatile prof_isr prof[PROF_ISR_COUNT];
+
+void prof_init(void);
+void prof_reset(void);
+// "$PROF,<id>,count,mean,max,latency*\n"
+void prof_format(char *reply, int id);
+
+static inline void prof_isr_exit(int id, uint16_t start) {
+    uint16_t cycles = TMR3 - start;
+    volatile prof_isr *p = &prof[id];
+    p->count++;
+    p->total += cycles;
+    if (cycles > p->max) {
+        p->max = cycles;
+    }
+}
+
+static inline void prof_isr_latency(int id, uint16_t cycles) {
+    if (cycles > prof[id].latency_max) {
+        prof[id].latency_max = cycles;
+    }
+}
+
+#ifdef	__cplusplus
+}
+#endif
+
+#if PROF_GPIO_ENABLE
+#define PROF_PIN(name, value) PROF_PIN_##name = (value)
+#else
+#define PROF_PIN(name, value)
+#endif
+
+#if PROF_ENABLE
+// first statement of the interrupt, declares the start time
+#define PROF_ISR_ENTER(name) uint16_t prof_start = TMR3; PROF_PIN(name, 1)
+// last statement of the interrupt
+#define PROF_ISR_EXIT(name) do { prof_isr_exit(PROF_##name, prof_start); PROF_PIN(name, 0); } while (0)
+// entry latency of a timer interrupt, counter ticks since the period match times the prescaler
+#define PROF_ISR_LATENCY(name, cycles) prof_isr_latency(PROF_##name, (cycles))
+#else
+#define PROF_ISR_ENTER(name)
+#define PROF_ISR_EXIT(name)
+#define PROF_ISR_LATENCY(name, cycles)
+#endif
+
+#endif	/* PROF_H */
@@ -0,0 +1,34 @@
+#include "rategen.h"
+
+static uint16_t period = 1;
+static uint32_t periods = 0; // since rategen_init, the common epoch
+
+void rategen_init(uint16_t period_ms) {
+    period = period_ms;
+    periods = 0;
+}
+
+int rategen_set(rate_gen *g, uint32_t rate_mhz) {
+    if (rate_mhz > RATEGEN_FULL / period) {
+        return 0;
+    }
+    uint32_t step = rate_mhz * period;
+    g->step = step;
+    g->rate_mhz = rate_mhz;
+    // where the generator would be had it run at this rate since the epoch
+    g->phase = (uint32_t)((uint64_t)periods * step % RATEGEN_FULL);
+    return 1;
+}
+
+int rategen_fire(rate_gen *g) {
+    g->phase += g->step;
+    if (g->phase >= RATEGEN_FULL) {
+        g->phase -= RATEGEN_FULL;
+        return 1;
+    }
+    return 0;
+}
+
+void rategen_advance(void) {
+    periods++;
+}
@@ -0,0 +1,45 @@
+/* 
+ * File:   rategen.h
+ * Author: EMBG2
+ * Comments: output rate generators for the telemetry streams. Each one
+ *           is a phase accumulator advanced once per control period: it
+ *           adds rate x period and fires when a full second (in mHz x ms)
+ *           is reached, keeping the remainder. Any rate up to the loop
+ *           rate works, in mHz steps, with an exact long run rate and a
+ *           jitter of at most one period. The phase of every generator is
+ *           taken from a common epoch, so streams whose rates divide each
+ *           other fire on the same periods, whenever they were set.
+ * Revision history: 
+ */
+
+#ifndef RATEGEN_H
+#define	RATEGEN_H
+
+#include <stdint.h>
+
+#define RATEGEN_FULL 1000000UL // mHz x ms in one cycle
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t phase;
+    uint32_t step;     // rate_mhz x period, at most RATEGEN_FULL
+    uint32_t rate_mhz;
+} rate_gen;
+
+// period of rategen_advance() calls, resets the epoch
+void rategen_init(uint16_t period_ms);
+// returns 0 (rate unchanged) if rate_mhz is above the loop rate
+int rategen_set(rate_gen *g, uint32_t rate_mhz);
+// nonzero when the stream is due in this period, call once per period
+int rategen_fire(rate_gen *g);
+// end of a period, call once after all rategen_fire()
+void rategen_advance(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* RATEGEN_H */
@@ -0,0 +1,34 @@
+#include "route.h"
+#include "uart.h"
+#include "txq.h"
+
+// everything on the primary link until a second consumer subscribes
+volatile uint8_t routes[ROUTE_COUNT] = {ROUTE_UART1, ROUTE_UART1, ROUTE_UART1};
+const char *const route_names[ROUTE_COUNT] = {"MAG", "YAW", "ATT"};
+
+int route_find(const char *name) {
+    for (int s = 0; s < ROUTE_COUNT; s++) {
+        const char *n = route_names[s];
+        int i = 0;
+        while (n[i] != '\0' && name[i] == n[i]) {
+            i++;
+        }
+        if (n[i] == '\0' && (name[i] == '\0' || name[i] == ',')) {
+            return s;
+        }
+    }
+    return -1;
+}
+
+int route_has(int stream, unsigned char uart) {
+    return routes[stream] & (1 << UART_INDEX(uart));
+}
+
+void route_send(int stream, int prio, const char *line) {
+    if (route_has(stream, UART_1)) {
+        txq_send(UART_1, prio, line);
+    }
+    if (route_has(stream, UART_2)) {
+        txq_send(UART_2, prio, line);
+    }
+}
@@ -0,0 +1,43 @@
+/* 
+ * File:   route.h
+ * Author: EMBG2
+ * Comments: routing table for the telemetry streams. Each stream has a
+ *           mask of the ports it goes to, changed at run time with
+ *           $ROUTE,<stream>,<mask>* (1 = UART1, 2 = UART2, 3 = both).
+ * Revision history: 
+ */
+
+#ifndef ROUTE_H
+#define	ROUTE_H
+
+#include <stdint.h>
+
+#define ROUTE_UART1 0x01
+#define ROUTE_UART2 0x02
+#define ROUTE_ALL (ROUTE_UART1 | ROUTE_UART2)
+
+// streams
+#define ROUTE_MAG 0
+#define ROUTE_YAW 1
+#define ROUTE_ATT 2
+#define ROUTE_COUNT 3
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+extern volatile uint8_t routes[ROUTE_COUNT];
+extern const char *const route_names[ROUTE_COUNT];
+
+// stream index from a "NAME" or "NAME,..." payload, -1 if unknown
+int route_find(const char *name);
+// nonzero when stream goes to uart
+int route_has(int stream, unsigned char uart);
+// queues line on every port of the stream
+void route_send(int stream, int prio, const char *line);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* ROUTE_H */
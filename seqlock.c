@@ -0,0 +1,46 @@
+#include "seqlock.h"
+#include <stddef.h>
+
+volatile unsigned int seqlock_retries = 0;
+
+void seqlock_init(seqlock_triple *s) {
+    for (int i = 0; i < 3; i++) {
+        s->v[0][i] = s->v[1][i] = 0;
+    }
+    s->t_us[0] = s->t_us[1] = 0;
+    s->seq = 0;
+}
+
+void seqlock_write(seqlock_triple *s, const int16_t v[3], uint32_t t_us) {
+    uint16_t next = s->seq + 1;
+    int slot = next & 1;
+    s->v[slot][0] = v[0];
+    s->v[slot][1] = v[1];
+    s->v[slot][2] = v[2];
+    s->t_us[slot] = t_us;
+    s->seq = next; // a single word write publishes the slot
+}
+
+uint16_t seqlock_read(const seqlock_triple *s, int16_t v[3], uint32_t *t_us) {
+    uint16_t before, after;
+    uint32_t t;
+    for (;;) {
+        before = s->seq;
+        int slot = before & 1;
+        v[0] = s->v[slot][0];
+        v[1] = s->v[slot][1];
+        v[2] = s->v[slot][2];
+        t = s->t_us[slot];
+        after = s->seq;
+        // write before + 1 went to the other slot, write before + 2 is the
+        // first one that can have touched this slot
+        if ((uint16_t)(after - before) < 2) {
+            break;
+        }
+        seqlock_retries++;
+    }
+    if (t_us != NULL) {
+        *t_us = t;
+    }
+    return before;
+}
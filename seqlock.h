@@ -0,0 +1,43 @@
+/* 
+ * File:   seqlock.h
+ * Author: EMBG2
+ * Comments: latest-sample snapshot of a sensor triple (magnetometer,
+ *           accelerometer, gyro) shared between one writer, possibly an
+ *           interrupt, and readers in the main loop. The writer fills the
+ *           slot readers are not directed to and then bumps a sequence
+ *           counter, so it never waits and never masks interrupts. A
+ *           reader copies the current slot and retries only if the
+ *           writer came back to that same slot meanwhile, i.e. after two
+ *           more writes.
+ * Revision history: 
+ */
+
+#ifndef SEQLOCK_H
+#define	SEQLOCK_H
+
+#include <stdint.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    volatile uint16_t seq;        // writes so far, slot seq & 1 holds the newest
+    volatile int16_t v[2][3];
+    volatile uint32_t t_us[2];    // acquisition time of each slot
+} seqlock_triple;
+
+extern volatile unsigned int seqlock_retries; // torn reads detected, over all snapshots
+
+void seqlock_init(seqlock_triple *s);
+// single writer only
+void seqlock_write(seqlock_triple *s, const int16_t v[3], uint32_t t_us);
+// copies the newest sample, returns its sequence number (0 before the first write);
+// t_us may be NULL
+uint16_t seqlock_read(const seqlock_triple *s, int16_t v[3], uint32_t *t_us);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SEQLOCK_H */
@@ -0,0 +1,62 @@
+#include "shed.h"
+#include <stdio.h>
+
+shed_state shed;
+
+static const uint8_t order[SHED_TASK_COUNT] = SHED_ORDER;
+
+void shed_init(void) {
+    shed.level = 0;
+    shed.mask = 0;
+    shed.calm = 0;
+    shed.min_slack = 1000;
+    shed.overruns = 0;
+    for (int i = 0; i < SHED_TASK_COUNT; i++) {
+        shed.skipped[i] = 0;
+    }
+}
+
+int shed_skip(int task) {
+    if (shed.mask & (1 << task)) {
+        shed.skipped[task]++;
+        return 1;
+    }
+    return 0;
+}
+
+int shed_update(uint16_t slack_permille) {
+    if (slack_permille < shed.min_slack) {
+        shed.min_slack = slack_permille;
+    }
+    if (slack_permille == 0) {
+        shed.overruns++;
+    }
+    if (slack_permille < SHED_LOW_PERMILLE) {
+        shed.calm = 0;
+        if (shed.level < SHED_TASK_COUNT) {
+            shed.mask |= 1 << order[shed.level];
+            shed.level++;
+            return 1;
+        }
+    } else if (slack_permille > SHED_HIGH_PERMILLE) {
+        if (shed.level > 0 && ++shed.calm >= SHED_RECOVER_PERIODS) {
+            shed.calm = 0;
+            shed.level--;
+            shed.mask &= ~(1 << order[shed.level]);
+            return 1;
+        }
+    } else {
+        shed.calm = 0;
+    }
+    return 0;
+}
+
+void shed_format_level(char *reply) {
+    sprintf(reply, "$SHED,%u,%u*\n", shed.level, shed.mask);
+}
+
+void shed_format(char *reply) {
+    sprintf(reply, "$SHED,%u,%u,%u,%u,%u,%u,%u,%u*\n", shed.level, shed.mask, shed.min_slack, shed.overruns,
+            shed.skipped[SHED_ATT], shed.skipped[SHED_MAG], shed.skipped[SHED_HEADING], shed.skipped[SHED_AHRS]);
+    shed.min_slack = 1000;
+}
@@ -0,0 +1,65 @@
+/* 
+ * File:   shed.h
+ * Author: EMBG2
+ * Comments: load shedding. The slack left in each control period is
+ *           measured on the loop timer; when it drops below
+ *           SHED_LOW_PERMILLE (or the period overran) the next optional
+ *           task in SHED_ORDER is skipped from then on, one more per
+ *           period. Tasks come back one at a time, last shed first, after
+ *           SHED_RECOVER_PERIODS periods in a row with more than
+ *           SHED_HIGH_PERMILLE of slack. Level changes are reported with
+ *           "$SHED,<level>,<mask>*" on UART1; $SHED* returns the state and
+ *           the skip counts.
+ * Revision history: 
+ */
+
+#ifndef SHED_H
+#define	SHED_H
+
+#include <stdint.h>
+
+// optional work
+#define SHED_ATT 0      // $ATT formatting
+#define SHED_MAG 1      // $MAG formatting, the next line carries the newest sample
+#define SHED_HEADING 2  // tilt compensated heading, $YAW repeats the last one
+#define SHED_AHRS 3     // orientation filter update
+#define SHED_TASK_COUNT 4
+
+// shed first to shed last
+#define SHED_ORDER {SHED_ATT, SHED_MAG, SHED_HEADING, SHED_AHRS}
+
+#define SHED_LOW_PERMILLE 100   // shed below 10 % of the period left
+#define SHED_HIGH_PERMILLE 300  // restore above 30 % ...
+#define SHED_RECOVER_PERIODS 50 // ... held for this many periods
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t level;                        // tasks shed, the first ones of SHED_ORDER
+    uint8_t mask;                         // 1 << task for every task shed
+    uint8_t calm;                         // periods in a row above SHED_HIGH_PERMILLE
+    uint16_t min_slack;                   // permille, lowest since the last $SHED*
+    uint16_t overruns;                    // periods without any slack
+    unsigned int skipped[SHED_TASK_COUNT]; // periods each task was skipped
+} shed_state;
+
+extern shed_state shed;
+
+void shed_init(void);
+// nonzero when task is to be skipped in this period, counts the skip
+int shed_skip(int task);
+// end of period: slack left in permille of the period, 0 if the next one is already due;
+// returns nonzero when the level changed
+int shed_update(uint16_t slack_permille);
+// "$SHED,<level>,<mask>*\n"
+void shed_format_level(char *reply);
+// "$SHED,<level>,<mask>,<min slack>,<overruns>,<skipped per task>*\n", restarts min slack
+void shed_format(char *reply);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SHED_H */
@@ -0,0 +1,74 @@
+#include "xc.h"
+#include "stats.h"
+#include "buffer.h"
+#include "command.h"
+#include "event.h"
+#include "txq.h"
+#include "uart.h"
+#include <stdio.h>
+#include <string.h>
+
+volatile runtime_stats stats;
+
+static const char *const type_names[STAT_TYPE_COUNT - 1] = STAT_TYPE_NAMES;
+
+void stats_count_type(const char *type) {
+    int i = 0;
+    while (i < STAT_TYPE_COUNT - 1 && strcmp(type, type_names[i]) != 0) {
+        i++;
+    }
+    stats.rx_types[i]++;
+}
+
+void stats_reset(void) {
+    int saved_ipl;
+    // every UART interrupt counts into these, both directions on both ports
+    SET_AND_SAVE_CPU_IPL(saved_ipl, 7);
+    memset((void *)&stats, 0, sizeof(stats));
+    memset((void *)&tx_stats_1, 0, sizeof(tx_stats_1));
+    memset((void *)&tx_stats_2, 0, sizeof(tx_stats_2));
+    memset((void *)&txq_stats_1, 0, sizeof(txq_stats_1));
+    memset((void *)&txq_stats_2, 0, sizeof(txq_stats_2));
+    ps_1.resets = 0;
+    ps_2.resets = 0;
+    event_overflows = 0;
+    main_buffer_1.high_water = main_buffer_1.count;
+    main_buffer_2.high_water = main_buffer_2.count;
+    transmit_buffer1.high_water = transmit_buffer1.count;
+    transmit_buffer2.high_water = transmit_buffer2.count;
+    RESTORE_CPU_IPL(saved_ipl);
+}
+
+void stats_format(char *reply) {
+    unsigned int txq_dropped = 0;
+    for (int p = 0; p < TXQ_PRIO_COUNT; p++) {
+        txq_dropped += txq_stats_1.dropped[p];
+    }
+    // UART1 receive side, transmit side, interrupt entries, then UART2 receive side
+    sprintf(reply, "$STAT,%u,%u,%u,%d,%u,%d,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u*\n",
+            stats.rx_overruns[0], stats.rx_dropped[0], ps_1.resets, main_buffer_1.high_water,
+            event_overflows,
+            transmit_buffer1.high_water, tx_stats_1.dropped_msgs, txq_dropped, txq_stats_1.coalesced,
+            stats.isr[STAT_ISR_U1RX], stats.isr[STAT_ISR_U1TX],
+            stats.isr[STAT_ISR_U2RX], stats.isr[STAT_ISR_U2TX], stats.isr[STAT_ISR_T2],
+            stats.rx_overruns[1], stats.rx_dropped[1]);
+}
+
+void stats_format_uart2(char *reply) {
+    unsigned int txq_dropped = 0;
+    for (int p = 0; p < TXQ_PRIO_COUNT; p++) {
+        txq_dropped += txq_stats_2.dropped[p];
+    }
+    // the UART1 fields of $STAT for the second port, receive side then transmit side
+    sprintf(reply, "$STAT,2,%u,%u,%u,%d,%d,%u,%u,%u*\n",
+            stats.rx_overruns[1], stats.rx_dropped[1], ps_2.resets, main_buffer_2.high_water,
+            transmit_buffer2.high_water, tx_stats_2.dropped_msgs, txq_dropped, txq_stats_2.coalesced);
+}
+
+void stats_format_types(char *reply) {
+    int len = sprintf(reply, "$STAT,TYPES");
+    for (int i = 0; i < STAT_TYPE_COUNT; i++) {
+        len += sprintf(reply + len, ",%u", stats.rx_types[i]);
+    }
+    sprintf(reply + len, "*\n");
+}
@@ -0,0 +1,58 @@
+/* 
+ * File:   stats.h
+ * Author: EMBG2
+ * Comments: runtime counters for sizing buffers and baud rates on real
+ *           traffic, read with $STAT*, $STAT,2* (UART2) and $STAT,TYPES*,
+ *           cleared with $STAT,RESET*. Counters are 16 bits and wrap.
+ * Revision history: 
+ */
+
+#ifndef STATS_H
+#define	STATS_H
+
+#include "uart.h"
+
+// interrupts with an entry counter
+#define STAT_ISR_U1RX 0
+#define STAT_ISR_U1TX 1
+#define STAT_ISR_U2RX 2
+#define STAT_ISR_U2TX 3
+#define STAT_ISR_T2 4
+#define STAT_ISR_U3RX 5
+#define STAT_ISR_U3TX 6
+#define STAT_ISR_U4RX 7
+#define STAT_ISR_U4TX 8
+#define STAT_ISR_COUNT 9
+
+// received message types, in the order of $STAT,TYPES*; the last one counts everything else
+#define STAT_TYPE_NAMES {"RATE", "CAL", "SYNC", "TS", "CAP", "DUMP", "ODR", "AHRS", "TRACE", "STAT", "PROF", "ROUTE", "MZ", "SHED", "DSP", "HDG"}
+#define STAT_TYPE_COUNT 17
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    unsigned int rx_overruns[UART_PORT_COUNT]; // hardware FIFO overruns (OERR), per port
+    unsigned int rx_dropped[UART_PORT_COUNT];  // bytes lost on a full receive buffer
+    unsigned int isr[STAT_ISR_COUNT];
+    unsigned int rx_types[STAT_TYPE_COUNT];
+} runtime_stats;
+
+extern volatile runtime_stats stats;
+
+// counts one received message of type
+void stats_count_type(const char *type);
+// clears every counter, including the ones kept by other modules.
+// Called from process_uart, with the RX interrupt of its port already masked
+void stats_reset(void);
+// "$STAT,...*\n", "$STAT,2,...*\n" and "$STAT,TYPES,...*\n" replies, reply must hold 120 bytes
+void stats_format(char *reply);
+void stats_format_uart2(char *reply);
+void stats_format_types(char *reply);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* STATS_H */
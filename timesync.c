@@ -0,0 +1,142 @@
+#include "xc.h"
+#include "timesync.h"
+#include "clock.h"
+#include "parser.h"
+#include <stdio.h>
+
+timesync_state timesync;
+
+// reception time of every '$' with its position in the RX byte stream, so a
+// byte lost on a full ring can never shift the stamps against the frames
+typedef struct {
+    uint16_t pos;
+    uint32_t t_us;
+} rx_stamp;
+
+static rx_stamp rx_stamps[SYNC_RX_STAMPS];
+static volatile uint8_t rx_stamp_head = 0;  // RX interrupt only
+static volatile uint8_t rx_stamp_tail = 0;  // process_uart only
+static volatile uint16_t rx_written = 0;    // RX interrupt only
+static uint16_t rx_read = 0;
+static uint32_t rx_frame_us = 0;
+
+// exchange in flight, completed by the t4 of the next request
+static unsigned long pending_seq;
+static uint32_t pending_t1, pending_t2;
+static volatile uint32_t pending_t3;
+static volatile int pending_t3_valid = 0;
+static int pending = 0;
+
+void timesync_init(void) {
+    timesync.offset_us = 0;
+    timesync.drift_q24 = 0;
+    timesync.ref_us = 0;
+    timesync.delay_us = 0;
+    timesync.exchanges = 0;
+    timesync.rejected = 0;
+    pending = 0;
+}
+
+void timesync_rx_byte(char byte) {
+    if (byte == '$' && (uint8_t)(rx_stamp_head - rx_stamp_tail) < SYNC_RX_STAMPS) {
+        rx_stamp *s = &rx_stamps[rx_stamp_head & (SYNC_RX_STAMPS - 1)];
+        s->pos = rx_written;
+        s->t_us = now_us();
+        rx_stamp_head++;
+    }
+    rx_written++;
+}
+
+uint32_t timesync_rx_span(int dollar, uint16_t len) {
+    uint16_t frame = rx_read + (uint16_t)dollar;
+    rx_read += len;
+    // every stamp up to the end of the span is used up, keep the frame's one
+    while (rx_stamp_tail != rx_stamp_head) {
+        rx_stamp *s = &rx_stamps[rx_stamp_tail & (SYNC_RX_STAMPS - 1)];
+        if ((int16_t)(rx_read - s->pos) <= 0) {
+            break;
+        }
+        rx_stamp_tail++;
+        if (dollar >= 0 && s->pos == frame) {
+            rx_frame_us = s->t_us;
+        }
+    }
+    return rx_frame_us;
+}
+
+int timesync_tx_line(const CircularBuffer *buf) {
+    static const char tag[] = "$SYNC";
+    for (int i = 0; i < 5; i++) {
+        if (buffer_peek(buf, i) != tag[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void timesync_tx_stamp(void) {
+    pending_t3 = now_us();
+    pending_t3_valid = 1;
+}
+
+static int32_t drift_correction(uint32_t board_us) {
+    return (int32_t)(((int64_t)timesync.drift_q24 * (int32_t)(board_us - timesync.ref_us)) >> 24);
+}
+
+static void timesync_sample(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4) {
+    int32_t delay = (int32_t)(t4 - t1) - (int32_t)(t3 - t2);
+    timesync.delay_us = delay;
+    if (delay < 0 || delay > SYNC_MAX_DELAY_US) {
+        timesync.rejected++;
+        return;
+    }
+    // ((t2 - t1) + (t3 - t4)) / 2 without leaving modulo 2^32 arithmetic
+    uint32_t offset = (t2 - t1) - (uint32_t)(delay / 2);
+    if (timesync.exchanges == 0) {
+        timesync.offset_us = offset;
+    } else {
+        int32_t dt = (int32_t)(t2 - timesync.ref_us);
+        uint32_t predicted = timesync.offset_us + (uint32_t)drift_correction(t2);
+        int32_t error = (int32_t)(offset - predicted);
+        if (dt > 0) {
+            int32_t rate = (int32_t)(((int64_t)error << 24) / dt);
+            timesync.drift_q24 += rate / SYNC_DRIFT_GAIN;
+        }
+        timesync.offset_us = predicted + (uint32_t)(error / SYNC_OFFSET_GAIN);
+    }
+    timesync.ref_us = t2;
+    timesync.exchanges++;
+}
+
+void timesync_request(const char *payload, uint32_t t2, char *reply) {
+    int i = 0;
+    unsigned long seq = extract_ulong(payload);
+    i = next_value(payload, i);
+    uint32_t t1 = extract_ulong(payload + i);
+    i = next_value(payload, i);
+    uint32_t t4 = extract_ulong(payload + i);
+
+    // t4 closes the previous exchange if it was the one right before this
+    if (pending && pending_t3_valid && seq == pending_seq + 1 && payload[i] != '\0') {
+        timesync_sample(pending_t1, pending_t2, pending_t3, t4);
+    }
+    uint32_t t3_prev = pending_t3;
+
+    pending_seq = seq;
+    pending_t1 = t1;
+    pending_t2 = t2;
+    pending_t3_valid = 0;
+    pending = 1;
+
+    // drift in parts per billion: 10^9 / 2^24 = 59.6
+    sprintf(reply, "$SYNC,%lu,%lu,%lu,%ld,%ld*\n", seq, (unsigned long)t2, (unsigned long)t3_prev,
+            (long)(int32_t)timesync.offset_us, (long)(((int64_t)timesync.drift_q24 * 1000000000LL) >> 24));
+}
+
+int timesync_valid(void) {
+    return timesync.exchanges > 0;
+}
+
+uint32_t timesync_to_host(uint32_t board_us) {
+    return board_us - timesync.offset_us - (uint32_t)drift_correction(board_us);
+}
@@ -0,0 +1,62 @@
+/* 
+ * File:   timesync.h
+ * Author: EMBG2
+ * Comments: alignment of the board clock (now_us) with the host clock.
+ *           The host sends $SYNC,seq,t1,t4prev* where t1 is its send
+ *           time and t4prev the time it received the previous reply.
+ *           The board stamps the '$' of the request on reception (t2)
+ *           and the '$' of its reply on transmission (t3), so every
+ *           exchange gives one NTP style offset sample. A small servo
+ *           filters the offset and estimates the crystal drift.
+ * Revision history: 
+ */
+
+#ifndef TIMESYNC_H
+#define	TIMESYNC_H
+
+#include <stdint.h>
+#include "buffer.h"
+
+#define SYNC_RX_STAMPS 8          // '$' bytes waiting in the RX buffer, power of two
+#define SYNC_MAX_DELAY_US 20000L  // round trips longer than this are ignored
+// servo gains, 1 / n of each offset error goes to the offset and the drift
+#define SYNC_OFFSET_GAIN 4
+#define SYNC_DRIFT_GAIN 16
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t offset_us; // board - host at ref_us, modulo 2^32
+    int32_t drift_q24;  // (board - host) rate difference, 2^-24 units
+    uint32_t ref_us;    // board time of the last accepted exchange
+    int32_t delay_us;   // round trip of the last exchange
+    unsigned int exchanges;
+    unsigned int rejected;
+} timesync_state;
+
+extern timesync_state timesync;
+
+void timesync_init(void);
+// UART1 RX interrupt, for every byte stored in main_buffer_1
+void timesync_rx_byte(char byte);
+// for len bytes taken from main_buffer_1 at once: by process_uart, and by
+// the RX interrupt for a byte it drops when the ring is full. dollar is
+// the offset of the '$' of a frame among them, or -1. Returns the reception
+// time of that frame, or of the last one seen if dollar is -1
+uint32_t timesync_rx_span(int dollar, uint16_t len);
+// UART1 TX interrupt: nonzero when the next line in buf is a $SYNC reply
+int timesync_tx_line(const CircularBuffer *buf);
+// UART1 TX interrupt, right before the '$' of a $SYNC reply is written
+void timesync_tx_stamp(void);
+// handles $SYNC,seq,t1,t4prev* received at board time t2, writes the reply
+void timesync_request(const char *payload, uint32_t t2, char *reply);
+int timesync_valid(void);
+uint32_t timesync_to_host(uint32_t board_us);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* TIMESYNC_H */
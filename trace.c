@@ -0,0 +1,129 @@
+#include "xc.h"
+#include "trace.h"
+#include "buffer.h"
+#include "uart.h"
+#include "txq.h"
+#include <stdio.h>
+
+#if UART_TRACE_ENABLE
+
+// 6 KB, more than the near RAM of the small data model
+#ifdef __XC16__
+#define TRACE_FAR __attribute__((far))
+#else
+#define TRACE_FAR
+#endif
+
+static trace_record_t TRACE_FAR trace[TRACE_SIZE];
+static volatile int trace_count = 0;
+static volatile int trace_running = 0;
+static volatile uint16_t trace_period = 0;
+
+// dump progress, owned by the TX interrupt once dumping is set
+static volatile int dumping = 0;
+static int dump_index; // records sent, -1 for the header
+// Timer2 period split at trace_dump_start so that a record converts
+// with 32-bit arithmetic: whole microseconds, plus the instruction
+// cycles left over
+static uint32_t dump_period_us;
+static uint16_t dump_period_rem;
+static uint16_t dump_prescaler;
+
+#define TRACE_LINE_MAX 14 // "4294967295 FF\n"
+#define CYCLES_PER_US (FCY / 1000000UL)
+
+static const unsigned int prescalers[4] = {1, 8, 64, 256};
+
+int trace_start(void) {
+    if (dumping) {
+        return 0;
+    }
+    trace_running = 0;
+    trace_count = 0;
+    trace_period = 0;
+    trace_running = 1;
+    return 1;
+}
+
+void trace_stop(void) {
+    trace_running = 0;
+}
+
+void trace_tick(void) {
+    if (trace_running) {
+        trace_period++;
+    }
+}
+
+void trace_record(char byte) {
+    if (!trace_running || trace_count == TRACE_SIZE) {
+        return;
+    }
+    trace_record_t *r = &trace[trace_count];
+    r->ticks = TMR2;
+    // the period has already elapsed if the tick interrupt has not run yet
+    r->period = trace_period + IFS0bits.T2IF;
+    r->byte = byte;
+    trace_count++;
+}
+
+int trace_dump_start(void) {
+    if (dumping) {
+        return 0;
+    }
+    trace_stop();
+    uint32_t period_cycles = ((uint32_t)PR2 + 1) * prescalers[T2CONbits.TCKPS];
+    dump_prescaler = prescalers[T2CONbits.TCKPS];
+    dump_period_us = period_cycles / CYCLES_PER_US;
+    dump_period_rem = period_cycles % CYCLES_PER_US;
+    dump_index = -1;
+    txq_hold(UART_1, 1); // no telemetry line may land in the middle of the dump
+    dumping = 1;
+    uart_tx_interrupt_enable(UART_1, 1);
+    return 1;
+}
+
+int trace_dumping(void) {
+    return dumping;
+}
+
+// copies a whole line into the transmit buffer, or nothing if it does not fit yet
+static int dump_line(const char *line, int len) {
+    if (buffer_free(&transmit_buffer1) < len) {
+        return 0;
+    }
+    for (int i = 0; i < len; i++) {
+        buffer_write(&transmit_buffer1, line[i]);
+    }
+    return 1;
+}
+
+// one line per TX interrupt, to keep the interrupt short
+void trace_dump_pump(void) {
+    char line[24];
+
+    if (!dumping) {
+        return;
+    }
+    if (dump_index < 0) {
+        if (dump_line(line, sprintf(line, "# trace %d\n", trace_count))) {
+            dump_index = 0;
+        }
+        return;
+    }
+    if (dump_index < trace_count && buffer_free(&transmit_buffer1) >= TRACE_LINE_MAX) {
+        const trace_record_t *r = &trace[dump_index];
+        // below 2^25, as the remainder is under CYCLES_PER_US and the prescaler at most 256
+        uint32_t cycles = (uint32_t)r->period * dump_period_rem + (uint32_t)r->ticks * dump_prescaler;
+        unsigned long t_us = r->period * dump_period_us + cycles / CYCLES_PER_US;
+        dump_line(line, sprintf(line, "%lu %02X\n", t_us, (unsigned char)r->byte));
+        dump_index++;
+    }
+    if (dump_index < trace_count) {
+        return;
+    }
+    dumping = 0;
+    txq_hold(UART_1, 0);
+}
+
+#endif
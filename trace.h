@@ -0,0 +1,57 @@
+/* 
+ * File:   trace.h
+ * Author: EMBG2
+ * Comments: RAM trace of the bytes received on UART1, used to record
+ *           real command traffic and replay it on the host (host/replay.c).
+ *           $TRACE,DUMP streams the records as text from the UART1 TX
+ *           interrupt, telemetry is held back until the dump is over.
+ * Revision history: 
+ */
+
+#ifndef TRACE_H
+#define	TRACE_H
+
+#include <stdint.h>
+
+#define UART_TRACE_ENABLE 1
+#define TRACE_SIZE 1024 // records, 6 bytes each
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint16_t period; // main loop periods elapsed since trace_start()
+    uint16_t ticks;  // TMR2 value inside the period
+    char byte;
+} trace_record_t;
+
+#if UART_TRACE_ENABLE
+// returns 0 while a dump is in progress
+int trace_start(void);
+void trace_stop(void);
+// called by the Timer2 interrupt once per period
+void trace_tick(void);
+// called by the RX interrupt for every received byte
+void trace_record(char byte);
+// stops the capture and starts sending "t_us hex_byte" lines on UART1,
+// returns 0 if a dump is already running
+int trace_dump_start(void);
+int trace_dumping(void);
+// UART1 TX interrupt: refills transmit_buffer1 while a dump is running
+void trace_dump_pump(void);
+#else
+#define trace_start() 1
+#define trace_stop()
+#define trace_tick()
+#define trace_record(byte)
+#define trace_dump_start() 1
+#define trace_dumping() 0
+#define trace_dump_pump()
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* TRACE_H */
@@ -0,0 +1,137 @@
+#include "txq.h"
+#include "uart.h"
+#include "buffer.h"
+
+CIRCULAR_BUFFER(txq_high_1, TXQ_HIGH_SIZE);
+CIRCULAR_BUFFER(txq_normal_1, TXQ_NORMAL_SIZE);
+CIRCULAR_BUFFER(txq_bulk_1, TXQ_BULK_SIZE);
+CIRCULAR_BUFFER(txq_high_2, TXQ_HIGH_SIZE);
+CIRCULAR_BUFFER(txq_normal_2, TXQ_NORMAL_SIZE);
+CIRCULAR_BUFFER(txq_bulk_2, TXQ_BULK_SIZE);
+
+volatile txq_stats txq_stats_1;
+volatile txq_stats txq_stats_2;
+
+typedef struct {
+    CircularBuffer *queues[TXQ_PRIO_COUNT];
+    CircularBuffer *transmit;
+    volatile txq_stats *stats;
+    volatile int held;
+} txq_port;
+
+static txq_port ports[TXQ_PORT_COUNT] = {
+    {{&txq_high_1, &txq_normal_1, &txq_bulk_1}, &transmit_buffer1, &txq_stats_1, 0},
+    {{&txq_high_2, &txq_normal_2, &txq_bulk_2}, &transmit_buffer2, &txq_stats_2, 0},
+};
+
+static int line_length(const char *line) {
+    int len = 1;
+    while (line[len - 1] != '\n') {
+        len++;
+    }
+    return len;
+}
+
+// length of the queued line starting at offset, including the '\n'
+static int queued_line_length(const CircularBuffer *queue, int offset) {
+    int len = 1;
+    while (buffer_peek(queue, offset + len - 1) != '\n') {
+        len++;
+    }
+    return len;
+}
+
+// true if the queued line at offset has the same "$TYPE," prefix as line
+static int same_type(const CircularBuffer *queue, int offset, const char *line) {
+    for (int i = 0; ; i++) {
+        int c = buffer_peek(queue, offset + i);
+        if (c != line[i]) {
+            return 0;
+        }
+        if (c == ',' || c == '*' || c == '\n') {
+            return 1;
+        }
+    }
+}
+
+int txq_send(unsigned char uart, int prio, const char *line) {
+    if (UART_INDEX(uart) >= TXQ_PORT_COUNT) {
+        return send_uart_string(uart, line);
+    }
+    txq_port *port = &ports[UART_INDEX(uart)];
+    CircularBuffer *queue = port->queues[prio];
+    int len = line_length(line);
+
+    uart_tx_interrupt_enable(uart, 0);
+    if (prio == TXQ_PRIO_BULK) {
+        // late telemetry is worthless: replace pending lines of the same type,
+        // then the oldest ones if there is still no room
+        int offset = 0;
+        while (offset < queue->count) {
+            if (same_type(queue, offset, line)) {
+                buffer_drop_line(queue, offset);
+                port->stats->coalesced++;
+            } else {
+                offset += queued_line_length(queue, offset);
+            }
+        }
+        while (buffer_free(queue) < len && buffer_drop_line(queue, 0) > 0) {
+            port->stats->dropped[prio]++;
+        }
+    }
+    if (buffer_free(queue) < len) {
+        port->stats->dropped[prio]++;
+        uart_tx_interrupt_enable(uart, 1);
+        return 0;
+    }
+    for (int i = 0; i < len; i++) {
+        buffer_write(queue, line[i]);
+    }
+    txq_pump(uart);
+    uart_tx_interrupt_enable(uart, 1);
+    return 1;
+}
+
+void txq_pump(unsigned char uart) {
+    if (UART_INDEX(uart) >= TXQ_PORT_COUNT) {
+        return;
+    }
+    txq_port *port = &ports[UART_INDEX(uart)];
+    char c;
+    int prio = 0;
+    if (port->held) {
+        return;
+    }
+    while (port->transmit->count < TXQ_LOW_WATER && prio < TXQ_PRIO_COUNT) {
+        CircularBuffer *queue = port->queues[prio];
+        if (queue->count == 0) {
+            prio++;
+            continue;
+        }
+        int len = queued_line_length(queue, 0);
+        if (buffer_free(port->transmit) < len) {
+            break;
+        }
+        for (int i = 0; i < len; i++) {
+            buffer_read(queue, &c);
+            buffer_write(port->transmit, c);
+        }
+        port->stats->sent[prio]++;
+        prio = 0;
+    }
+}
+
+void txq_hold(unsigned char uart, int hold) {
+    if (UART_INDEX(uart) < TXQ_PORT_COUNT) {
+        ports[UART_INDEX(uart)].held = hold;
+    }
+}
+
+int txq_pending(unsigned char uart) {
+    if (UART_INDEX(uart) >= TXQ_PORT_COUNT) {
+        return 0;
+    }
+    txq_port *port = &ports[UART_INDEX(uart)];
+    return port->queues[TXQ_PRIO_HIGH]->count + port->queues[TXQ_PRIO_NORMAL]->count
+           + port->queues[TXQ_PRIO_BULK]->count;
+}
@@ -0,0 +1,52 @@
+/* 
+ * File:   txq.h
+ * Author: EMBG2
+ * Comments: message level TX queue with priority classes in front of the
+ *           UART1 transmit buffer. Lines wait here and are moved into
+ *           transmit_buffer1 by the TX interrupt only when it runs low, so a
+ *           high priority line never waits behind more than TXQ_LOW_WATER
+ *           bytes of older traffic. UART1 and UART2 have one set of
+ *           queues each, other ports go straight to send_uart_string().
+ * Revision history: 
+ */
+
+#ifndef TXQ_H
+#define	TXQ_H
+
+#define TXQ_PRIO_HIGH 0   // command responses and heading
+#define TXQ_PRIO_NORMAL 1
+#define TXQ_PRIO_BULK 2   // telemetry, a newer line replaces a pending one of the same type
+#define TXQ_PRIO_COUNT 3
+
+#define TXQ_HIGH_SIZE 160
+#define TXQ_NORMAL_SIZE 128 // two full $MZ lines
+#define TXQ_BULK_SIZE 48
+#define TXQ_PORT_COUNT 2
+#define TXQ_LOW_WATER 16 // refill transmit_buffer1 below this many bytes
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    unsigned int sent[TXQ_PRIO_COUNT];
+    unsigned int dropped[TXQ_PRIO_COUNT];
+    unsigned int coalesced;
+} txq_stats;
+
+extern volatile txq_stats txq_stats_1;
+extern volatile txq_stats txq_stats_2;
+
+// queues a '\n' terminated line, returns 0 if it was dropped
+int txq_send(unsigned char uart, int prio, const char *line);
+// moves queued lines into the transmit buffer, highest priority first
+void txq_pump(unsigned char uart);
+// while held, lines stay queued and the transmit buffer belongs to someone else
+void txq_hold(unsigned char uart, int hold);
+int txq_pending(unsigned char uart);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* TXQ_H */
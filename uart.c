@@ -2,131 +2,304 @@
 #include "uart.h"
 #include "timer.h"
 #include "buffer.h"
+#include "trace.h"
+#include "txq.h"
+#include "event.h"
+#include "timesync.h"
+#include "clock.h"
+#include "capture.h"
+#include "stats.h"
+#include "prof.h"
 
+// UxMODE, UxSTA and interrupt register bits used through the port table
+#define UMODE_UARTEN (1u << 15)
+#define USTA_URXDA (1u << 0)
+#define USTA_OERR (1u << 1)
+#define USTA_TRMT (1u << 8)
+#define USTA_UTXBF (1u << 9)
+#define USTA_UTXEN (1u << 10)
+#define USTA_UTXISEL0 (1u << 13)
 
-void send_uart_char(unsigned char uart, char data) {
-    if (uart == UART_1) {
-        buffer_write(&transmit_buffer1, data);
-    } else if (uart == UART_2) {
-        buffer_write(&transmit_buffer2, data);
-    }
-}
+// register access through the port table, host/xc.h hooks it for the simulator
+#ifndef SFR_DEREF
+#define SFR_DEREF(reg) (*(reg))
+#endif
 
-void send_uart_string(unsigned char uart, const char *buffer) {
-    IEC0bits.U1TXIE = 0;
-    if (uart == UART_1){
-        while (*buffer != '\n') {
-            send_uart_char(UART_1, *buffer++);
-        }
-        send_uart_char(UART_1, '\n');
+volatile uart_tx_stats tx_stats_1;
+volatile uart_tx_stats tx_stats_2;
+#if UART_PORT_COUNT > 2
+volatile uart_tx_stats tx_stats_3;
+volatile uart_tx_stats tx_stats_4;
+CIRCULAR_BUFFER(main_buffer_3, RX_BUFFER_SIZE);
+CIRCULAR_BUFFER(main_buffer_4, RX_BUFFER_SIZE);
+CIRCULAR_BUFFER(transmit_buffer3, TX_BUFFER_SIZE);
+CIRCULAR_BUFFER(transmit_buffer4, TX_BUFFER_SIZE);
+#endif
+
+typedef struct {
+    volatile unsigned int *mode;
+    volatile unsigned int *sta;
+    volatile unsigned int *brg;
+    volatile unsigned int *txreg;
+    volatile unsigned int *rxreg;
+    volatile unsigned int *iec;     // holds both the RX and the TX enable bit
+    unsigned int rx_ie;
+    unsigned int tx_ie;
+    unsigned long baud;
+    CircularBuffer *rx;
+    CircularBuffer *tx;
+    volatile uart_tx_stats *tx_stats;
+    uint8_t primary;                // UART1: trace, $SYNC stamps and $DUMP
+    uint8_t event_lane;
+    uint8_t frame_event;            // posted when a '*' arrives, EVENT_NONE for raw ports
+    uint8_t isr_rx;                 // stats.isr slots
+    uint8_t isr_tx;
+    // set while the TX interrupt is in the middle of a line, so that
+    // UART_TX_OVERWRITE never cuts the line that is on the wire
+    volatile uint8_t tx_line_open;
+} uart_port;
+
+static uart_port ports[UART_PORT_COUNT] = {
+    {&U1MODE, &U1STA, &U1BRG, &U1TXREG, &U1RXREG, &IEC0, 1u << 11, 1u << 12, BAUDRATE,
+     &main_buffer_1, &transmit_buffer1, &tx_stats_1, 1, EVENT_LANE_UART1_RX, EVENT_RX_FRAME_1,
+     STAT_ISR_U1RX, STAT_ISR_U1TX, 0},
+    {&U2MODE, &U2STA, &U2BRG, &U2TXREG, &U2RXREG, &IEC1, 1u << 14, 1u << 15, UART2_BAUDRATE,
+     &main_buffer_2, &transmit_buffer2, &tx_stats_2, 0, EVENT_LANE_UART2_RX, EVENT_RX_FRAME_2,
+     STAT_ISR_U2RX, STAT_ISR_U2TX, 0},
+#if UART_PORT_COUNT > 2
+    {&U3MODE, &U3STA, &U3BRG, &U3TXREG, &U3RXREG, &IEC5, 1u << 2, 1u << 3, UART3_BAUDRATE,
+     &main_buffer_3, &transmit_buffer3, &tx_stats_3, 0, 0, EVENT_NONE,
+     STAT_ISR_U3RX, STAT_ISR_U3TX, 0},
+    {&U4MODE, &U4STA, &U4BRG, &U4TXREG, &U4RXREG, &IEC5, 1u << 8, 1u << 9, UART4_BAUDRATE,
+     &main_buffer_4, &transmit_buffer4, &tx_stats_4, 0, 0, EVENT_NONE,
+     STAT_ISR_U4RX, STAT_ISR_U4TX, 0},
+#endif
+};
+
+// read-modify-write of an IEC register from the main loop: the TX
+// interrupts write the same registers, so keep them out meanwhile
+static void iec_write(volatile unsigned int *iec, unsigned int bit, int enable) {
+    int saved_ipl;
+    SET_AND_SAVE_CPU_IPL(saved_ipl, 7);
+    if (enable) {
+        SFR_DEREF(iec) |= bit;
     } else {
-        while (*buffer != '\n') {
-            send_uart_char(UART_2, *buffer++);
-        }
-        send_uart_char(UART_2, '\n');
+        SFR_DEREF(iec) &= ~bit;
     }
-    IEC0bits.U1TXIE = 1;
+    RESTORE_CPU_IPL(saved_ipl);
 }
 
-void UART_Init(unsigned char uart) {
-    if (uart == UART_1) {
-        // Configure UART1
-        U1MODEbits.UARTEN = 0;   // Disable UART1
-        RPOR0bits.RP64R = 1;     // TX pin mapping
-        RPINR18bits.U1RXR = 75;  // RX pin mapping
-        U1MODEbits.UARTEN = 0;   // disable UART
-        U1MODEbits.STSEL = 0;    // Stop bit
-        U1MODEbits.PDSEL = 0;    // Parity
-        U1MODEbits.ABAUD = 0;    // Auto-baud disabled
-        U1MODEbits.BRGH = 0;     // Low-speed mode
-        U1BRG = BRGVAL;          // Baud rate
-        IEC0bits.U1RXIE = 1;
-        IFS0bits.U1RXIF =0;
-        IEC0bits.U1TXIE = 0;
-        IFS0bits.U1TXIF =0;
-        U1MODEbits.UARTEN = 1;   // Enable UART1
-        U1STAbits.UTXEN = 1;     // Enable transmitter
-        
-    } else if (uart == UART_2) {
-        // Configure UART2
-        U2MODEbits.UARTEN = 0;   // Disable UART2
-        RPOR0bits.RP64R = 3;     // TX pin mapping
-        RPINR19bits.U2RXR = 75;  // RX pin mapping
-        U2MODEbits.STSEL = 1;    // Stop bit
-        U2MODEbits.PDSEL = 0;    // Parity
-        U2MODEbits.ABAUD = 0;    // Auto-baud disabled
-        U2MODEbits.BRGH = 0;     // Low-speed mode
-        U2BRG = BRGVAL;          // Baud rate
-        IEC1bits.U2RXIE = 1;
-        IFS1bits.U2RXIF =0;
-        IEC1bits.U2TXIE = 0;
-        IFS1bits.U2TXIF =0;
-        U2MODEbits.UARTEN = 1;   // Enable UART2
-        U2STAbits.UTXEN = 1;     // Enable transmitter
+void uart_tx_interrupt_enable(unsigned char uart, int enable) {
+    const uart_port *p = &ports[UART_INDEX(uart)];
+    iec_write(p->iec, p->tx_ie, enable);
+}
+
+void uart_rx_interrupt_enable(unsigned char uart, int enable) {
+    const uart_port *p = &ports[UART_INDEX(uart)];
+    iec_write(p->iec, p->rx_ie, enable);
+}
+
+void send_uart_char(unsigned char uart, char data) {
+    const uart_port *p = &ports[UART_INDEX(uart)];
+    if (!buffer_write(p->tx, data)) {
+        p->tx_stats->dropped_bytes++;
     }
 }
 
-void __attribute__((__interrupt__, auto_psv)) _U1RXInterrupt(void) {
-    IFS0bits.U1RXIF = 0;
-    while (U1STAbits.URXDA) {
-#if UART_OVERWRITE_ON_FULL
-        while (!buffer_write(&main_buffer_1, U1RXREG)) {
-            char tmp;
-            buffer_read(&main_buffer_1, &tmp);
+int send_uart_string(unsigned char uart, const char *buffer) {
+    uart_port *p = &ports[UART_INDEX(uart)];
+    CircularBuffer *tx = p->tx;
+    volatile uart_tx_stats *stats = p->tx_stats;
+    int len = 1;
+    while (buffer[len - 1] != '\n') {
+        len++;
+    }
+
+#if UART_TX_POLICY == UART_TX_BLOCKING
+    // the TX interrupt stays enabled and drains the buffer meanwhile
+    if (buffer_free(tx) < len) {
+        uint32_t start = now_us();
+        uart_tx_interrupt_enable(uart, 1);
+        while (buffer_free(tx) < len && now_us() - start < UART_TX_BLOCK_US) {
         }
-#else
-        char incoming = U1RXREG;
-        buffer_write(&main_buffer_1, incoming);
+    }
 #endif
+    uart_tx_interrupt_enable(uart, 0);
+#if UART_TX_POLICY == UART_TX_OVERWRITE
+    if (len <= tx->size) {
+        int keep = 0;
+        if (p->tx_line_open) {
+            // keep the rest of the line being transmitted
+            while (keep < tx->count && buffer_peek(tx, keep) != '\n') {
+                keep++;
+            }
+            keep++;
+        }
+        while (buffer_free(tx) < len && buffer_drop_line(tx, keep) > 0) {
+            stats->overwritten_msgs++;
+        }
+    }
+#endif
+    if (buffer_free(tx) < len) {
+        stats->dropped_msgs++;
+        stats->dropped_bytes += len;
+        uart_tx_interrupt_enable(uart, tx->count > 0);
+        return 0;
     }
-    if (U1STAbits.OERR){
-        U1STAbits.OERR = 0;
+    for (int i = 0; i < len; i++) {
+        buffer_write(tx, buffer[i]);
     }
+    stats->sent_msgs++;
+    uart_tx_interrupt_enable(uart, 1);
+    return 1;
 }
 
-void __attribute__((__interrupt__, auto_psv)) _U2RXInterrupt(void) {  
-    IFS1bits.U2RXIF = 0;
-    while (U2STAbits.URXDA) {
+// peripheral pin select is board wiring, the rest of the setup is the same for every port
+static void uart_map_pins(unsigned char uart) {
+    switch (uart) {
+        case UART_1:
+            RPOR0bits.RP64R = 1;     // TX pin mapping
+            RPINR18bits.U1RXR = 75;  // RX pin mapping
+            break;
+        case UART_2:
+            RPOR0bits.RP65R = 3;     // TX pin mapping, RD1 (RP64 is the UART1 TX)
+            RPINR19bits.U2RXR = 76;  // RX pin mapping, RD12 (RPI75 is the UART1 RX)
+            break;
+        default:
+            // UART3 and UART4 have no connector on this board, map their pins here when used
+            break;
+    }
+}
+
+void UART_Init(unsigned char uart) {
+    const uart_port *p = &ports[UART_INDEX(uart)];
+    SFR_DEREF(p->mode) = 0;                 // disabled, 8N1, no auto-baud, low-speed mode
+    uart_map_pins(uart);
+    SFR_DEREF(p->brg) = UART_BRG(p->baud);  // Baud rate
+    iec_write(p->iec, p->tx_ie, 0);
+    iec_write(p->iec, p->rx_ie, 1);
+    SFR_DEREF(p->mode) = UMODE_UARTEN;      // Enable the UART
+    SFR_DEREF(p->sta) |= USTA_UTXEN;        // Enable transmitter
+}
+
+// shared interrupt bodies, the vectors below only clear their own flag
+// (a BCLR, so no other flag in the IFS register can be lost) and profile
+
+static void uart_rx_isr(uart_port *p) {
+    stats.isr[p->isr_rx]++;
+    while (SFR_DEREF(p->sta) & USTA_URXDA) {
+        char incoming = SFR_DEREF(p->rxreg);
+        if (p->primary) {
+            trace_record(incoming);
+        }
 #if UART_OVERWRITE_ON_FULL
-        while (!buffer_write(&main_buffer_2, U2RXREG)) {
+        while (!buffer_write(p->rx, incoming)) {
             char tmp;
-            buffer_read(&main_buffer_2, &tmp);
+            buffer_read(p->rx, &tmp);
+            if (p->primary) {
+                timesync_rx_span(-1, 1); // keep the stamp positions in step
+            }
+            stats.rx_dropped[p - ports]++;
+        }
+        if (p->primary) {
+            timesync_rx_byte(incoming);
         }
 #else
-        buffer_write(&main_buffer_2, U2RXREG);
+        if (buffer_write(p->rx, incoming)) {
+            if (p->primary) {
+                timesync_rx_byte(incoming);
+            }
+        } else {
+            stats.rx_dropped[p - ports]++;
+        }
 #endif
+        if (incoming == '*' && p->frame_event != EVENT_NONE) {
+            event_post(p->event_lane, p->frame_event);
+        }
     }
-    if (U2STAbits.OERR){
-        U2STAbits.OERR = 0;
+    if (SFR_DEREF(p->sta) & USTA_OERR) {
+        stats.rx_overruns[p - ports]++;
+        SFR_DEREF(p->sta) &= ~USTA_OERR;
     }
 }
 
-void __attribute__((__interrupt__, auto_psv)) _U1TXInterrupt(void){
-    IFS0bits.U1TXIF = 0;
+static void uart_tx_isr(uart_port *p, unsigned char uart) {
     char data;
+    stats.isr[p->isr_tx]++;
+
+    txq_pump(uart);
+    if (p->primary) {
+        capture_dump_pump();
+        trace_dump_pump();
+    }
 
-    while (transmit_buffer1.count > 0 && !U1STAbits.UTXBF) {
-        buffer_read(&transmit_buffer1, &data);
-        U1TXREG = data;
+    while (p->tx->count > 0 && !(SFR_DEREF(p->sta) & USTA_UTXBF)) {
+        if (p->primary && !p->tx_line_open && timesync_tx_line(p->tx)) {
+            // a $SYNC reply leaves an empty transmitter so its stamp is exact:
+            // interrupt again when the last queued bit has gone out
+            SFR_DEREF(p->sta) |= USTA_UTXISEL0;
+            if (!(SFR_DEREF(p->sta) & USTA_TRMT)) {
+                break;
+            }
+            SFR_DEREF(p->sta) &= ~USTA_UTXISEL0;
+            timesync_tx_stamp();
+        }
+        buffer_read(p->tx, &data);
+        SFR_DEREF(p->txreg) = data;
+        p->tx_line_open = (data != '\n');
     }
 
-    if (transmit_buffer1.count <= 0){
-        IEC0bits.U1TXIE = 0;
+    if (p->tx->count <= 0) {
+        SFR_DEREF(p->iec) &= ~p->tx_ie; // interrupts of the same priority do not nest
     }
 }
 
+void __attribute__((__interrupt__, auto_psv)) _U1RXInterrupt(void) {
+    PROF_ISR_ENTER(U1RX);
+    IFS0bits.U1RXIF = 0;
+    uart_rx_isr(&ports[0]);
+    PROF_ISR_EXIT(U1RX);
+}
+
+void __attribute__((__interrupt__, auto_psv)) _U2RXInterrupt(void) {
+    PROF_ISR_ENTER(U2RX);
+    IFS1bits.U2RXIF = 0;
+    uart_rx_isr(&ports[1]);
+    PROF_ISR_EXIT(U2RX);
+}
 
+void __attribute__((__interrupt__, auto_psv)) _U1TXInterrupt(void) {
+    PROF_ISR_ENTER(U1TX);
+    IFS0bits.U1TXIF = 0;
+    uart_tx_isr(&ports[0], UART_1);
+    PROF_ISR_EXIT(U1TX);
+}
 
-void __attribute__((__interrupt__, auto_psv)) _U2TXInterrupt(void){
+void __attribute__((__interrupt__, auto_psv)) _U2TXInterrupt(void) {
+    PROF_ISR_ENTER(U2TX);
     IFS1bits.U2TXIF = 0;
-    char data;
-    
-    while (transmit_buffer2.count > 0 && !U2STAbits.UTXBF) {
-        buffer_read(&transmit_buffer2, &data);
-        U2TXREG = data;
-    }
-   
-    if (transmit_buffer2.count <= 0){
-        IEC1bits.U2TXIE = 0;
-    }
+    uart_tx_isr(&ports[1], UART_2);
+    PROF_ISR_EXIT(U2TX);
+}
+
+#if UART_PORT_COUNT > 2
+void __attribute__((__interrupt__, auto_psv)) _U3RXInterrupt(void) {
+    IFS5bits.U3RXIF = 0;
+    uart_rx_isr(&ports[2]);
+}
+
+void __attribute__((__interrupt__, auto_psv)) _U4RXInterrupt(void) {
+    IFS5bits.U4RXIF = 0;
+    uart_rx_isr(&ports[3]);
+}
+
+void __attribute__((__interrupt__, auto_psv)) _U3TXInterrupt(void) {
+    IFS5bits.U3TXIF = 0;
+    uart_tx_isr(&ports[2], UART_3);
+}
+
+void __attribute__((__interrupt__, auto_psv)) _U4TXInterrupt(void) {
+    IFS5bits.U4TXIF = 0;
+    uart_tx_isr(&ports[3], UART_4);
 }
+#endif
@@ -13,23 +13,65 @@
 
 #define UART_1 1
 #define UART_2 2
+#define UART_3 3
+#define UART_4 4
+#define UART_INDEX(uart) ((uart) - 1) // per port arrays: [0] UART1, [1] UART2, ...
+// ports served by the driver; 4 adds UART3 and UART4 with their buffers
+#define UART_PORT_COUNT 2
 
 #define FCY 72000000UL
-#define BAUDRATE 9600
-#define BRGVAL ((FCY / BAUDRATE) / 16 - 1)
+#define BAUDRATE 9600           // UART1, the primary link
+#define UART2_BAUDRATE 115200   // UART2, for a high rate consumer
+#define UART3_BAUDRATE 115200
+#define UART4_BAUDRATE 115200
+#define UART_BRG(baud) ((FCY / (baud)) / 16 - 1)
+#define BRGVAL UART_BRG(BAUDRATE)
 
 #define UART_OVERWRITE_ON_FULL 0
 
+// what send_uart_string does when the line does not fit in the TX buffer
+#define UART_TX_ATOMIC 0    // drop the whole line
+#define UART_TX_BLOCKING 1  // wait for the TX interrupt to make room, drop the line on timeout
+#define UART_TX_OVERWRITE 2 // drop the oldest queued lines until the new one fits
+#define UART_TX_POLICY UART_TX_ATOMIC
+#define UART_TX_BLOCK_US 2100 // two characters at 9600 baud
+
+typedef struct {
+    unsigned int sent_msgs;
+    unsigned int dropped_msgs;     // lines rejected because they did not fit
+    unsigned int dropped_bytes;    // bytes rejected by send_uart_char and dropped lines
+    unsigned int overwritten_msgs; // queued lines discarded by UART_TX_OVERWRITE
+} uart_tx_stats;
+
+extern volatile uart_tx_stats tx_stats_1;
+extern volatile uart_tx_stats tx_stats_2;
+#if UART_PORT_COUNT > 2
+extern volatile uart_tx_stats tx_stats_3;
+extern volatile uart_tx_stats tx_stats_4;
+extern CircularBuffer main_buffer_3;
+extern CircularBuffer main_buffer_4;
+extern CircularBuffer transmit_buffer3;
+extern CircularBuffer transmit_buffer4;
+#endif
+
+void uart_tx_interrupt_enable(unsigned char uart, int enable);
+void uart_rx_interrupt_enable(unsigned char uart, int enable);
 void send_uart_char(unsigned char uart, char data);
-void send_uart_string(unsigned char uart, const char *buffer);
+// queues a '\n' terminated line as a whole, returns 0 if it was dropped
+int send_uart_string(unsigned char uart, const char *buffer);
 void UART_Init(unsigned char uart);
-void process_uart(void);
 
 // interrupt function declarations
 extern void __attribute__((__interrupt__, auto_psv)) _U1RXInterrupt(void);
 extern void __attribute__((__interrupt__, auto_psv)) _U2RXInterrupt(void);
 extern void __attribute__((__interrupt__, auto_psv)) _U1TXInterrupt(void);
 extern void __attribute__((__interrupt__, auto_psv)) _U2TXInterrupt(void);
+#if UART_PORT_COUNT > 2
+extern void __attribute__((__interrupt__, auto_psv)) _U3RXInterrupt(void);
+extern void __attribute__((__interrupt__, auto_psv)) _U4RXInterrupt(void);
+extern void __attribute__((__interrupt__, auto_psv)) _U3TXInterrupt(void);
+extern void __attribute__((__interrupt__, auto_psv)) _U4TXInterrupt(void);
+#endif
 
 #ifdef	__cplusplus
 extern "C" {